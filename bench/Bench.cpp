@@ -0,0 +1,601 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "FixedEngine.h"
+#include "GoL.h"
+#include "Kernel.h"
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+#else
+
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#endif
+
+using namespace std;
+
+/**
+ * An engine and the topology it runs in, as chosen by the options of the program.
+ */
+struct Config
+{
+    const char* engine;
+    EngineType type;
+    const char* mode; // "border", "noBorder" or "unbounded"
+    int threads;
+    int processes;
+};
+
+/**
+ * The result of timing a case.
+ */
+struct Measurement
+{
+    long generations;
+    double seconds;
+    uint64_t historyBytes;
+    uint64_t peakRss;
+    char error[160]; // empty if the case ran
+};
+
+/**
+ * A naive stepper, the reference the engines are checked against. Each cell is a byte
+ * and counts its neighbours one by one. An unbounded universe is a board large enough
+ * that the cells can not reach its edge within the generations checked.
+ */
+class Reference
+{
+private:
+    int lines, columns, margin;
+    bool wrap;
+    Rule rule;
+    vector<uint8_t> cells, next;
+
+public:
+    Reference(const BitBoard& start, const Rule& rule, const char* mode, const int& generations)
+            : margin(strcmp(mode, "unbounded") == 0 ? generations + 2 : 0),
+              wrap(strcmp(mode, "noBorder") == 0), rule(rule)
+    {
+        lines = start.getLines() + 2 * margin;
+        columns = start.getColumns() + 2 * margin;
+        cells.assign((size_t) lines * columns, 0);
+        next = cells;
+        for (int i = 0; i != start.getLines(); ++i)
+            for (int j = 0; j != start.getColumns(); ++j)
+                cells[(size_t) (i + margin) * columns + j + margin] = start.get(i, j);
+    }
+
+    void step()
+    {
+        for (int i = 0; i != lines; ++i)
+            for (int j = 0; j != columns; ++j)
+            {
+                int live = 0;
+                for (int di = -1; di <= 1; ++di)
+                    for (int dj = -1; dj <= 1; ++dj)
+                    {
+                        if (di == 0 && dj == 0) continue;
+                        int l = i + di, c = j + dj;
+                        if (wrap)
+                        {
+                            l = (l + lines) % lines;
+                            c = (c + columns) % columns;
+                        }
+                        else if (l < 0 || l >= lines || c < 0 || c >= columns)
+                            continue;
+                        live += cells[(size_t) l * columns + c];
+                    }
+                next[(size_t) i * columns + j] = rule.next(cells[(size_t) i * columns + j] != 0, live);
+            }
+        cells.swap(next);
+    }
+
+    /**
+     * Gets the live cells within a rectangle, by their location on the starting board.
+     */
+    vector<pair<int, int>> live(const int& top, const int& left, const int& bottom, const int& right) const
+    {
+        vector<pair<int, int>> found;
+        for (int i = max(top + margin, 0); i < min(bottom + margin, lines); ++i)
+            for (int j = max(left + margin, 0); j < min(right + margin, columns); ++j)
+                if (cells[(size_t) i * columns + j]) found.emplace_back(i - margin, j - margin);
+        return found;
+    }
+
+    /**
+     * Gets all the live cells, by their location on the starting board.
+     */
+    vector<pair<int, int>> live() const
+    {
+        return live(-margin, -margin, lines - margin, columns - margin);
+    }
+};
+
+static double caseSeconds = 0.5;
+static bool flQuick = false;
+static uint64_t seed = 1;
+static string outputPath, examplesPath = GOL_EXAMPLE_DIR;
+
+/**
+ * Gets the highest resident memory of the process so far, 0 if unknown.
+ */
+static uint64_t peakRss()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return (uint64_t) usage.ru_maxrss;
+#else
+    return (uint64_t) usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+/**
+ * Escapes a string for JSON.
+ */
+static string quote(const string& text)
+{
+    string quoted = "\"";
+    for (const char& c : text)
+    {
+        if (c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + '"';
+}
+
+/**
+ * Does the engine of a config run on a board? The fixed-size engine is only timed and
+ * checked on the sizes which have one, elsewhere it would be the cell engine again.
+ */
+static bool runsOn(const Config& config, const BitBoard& start)
+{
+    return config.type != ENGINE_FIXED || createFixedEngine(start.getLines(), start.getColumns()) != nullptr;
+}
+
+/**
+ * Creates a game with an engine and a starting board.
+ */
+static void setUp(GoL& app, const Config& config, const BitBoard& start, const Rule& rule)
+{
+    app.setVerbose(false).setEngine(config.type).setRule(rule).setThreads(config.threads)
+            .setProcesses(config.processes).toggleNoBorder(strcmp(config.mode, "noBorder") == 0).init(start);
+}
+
+/**
+ * Times run() (or forward() if jump) for about caseSeconds, in batches of doubling size
+ * so that reading the clock costs nothing on small boards.
+ */
+static Measurement timeCase(const Config& config, const BitBoard& start, const Rule& rule, const bool& jump)
+{
+    const long limit = 1L << 20;
+    Measurement m{};
+    GoL app;
+    setUp(app, config, start, rule);
+    const auto begin = chrono::steady_clock::now();
+    for (long batch = 1; m.generations < limit && m.seconds < caseSeconds; batch *= 2)
+    {
+        const long steps = min(batch, limit - m.generations);
+        if (jump)
+            app.forward((int) steps);
+        else
+            for (long s = 0; s != steps; ++s)
+                app.run();
+        m.generations += steps;
+        m.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    }
+    m.historyBytes = app.getHistoryBytes();
+    m.peakRss = peakRss();
+    return m;
+}
+
+/**
+ * Times a case in a child process of its own, so that the peak resident memory is the
+ * one of the case alone. Runs it in this process on Windows.
+ */
+static Measurement measure(const Config& config, const BitBoard& start, const Rule& rule, const bool& jump)
+{
+    Measurement m{};
+#ifdef _WIN32
+    try
+    {
+        m = timeCase(config, start, rule, jump);
+    }
+    catch (const exception& e)
+    {
+        strncpy(m.error, e.what(), sizeof(m.error) - 1);
+    }
+#else
+    int fds[2];
+    if (pipe(fds) != 0) throw runtime_error("Unable to create a pipe");
+    cout.flush();
+    const pid_t pid = fork();
+    if (pid < 0) throw runtime_error("Unable to start a process");
+    if (pid == 0)
+    {
+        close(fds[0]);
+        try
+        {
+            m = timeCase(config, start, rule, jump);
+        }
+        catch (const exception& e)
+        {
+            strncpy(m.error, e.what(), sizeof(m.error) - 1);
+        }
+        const bool written = write(fds[1], &m, sizeof(m)) == (ssize_t) sizeof(m);
+        _exit(written ? 0 : 1);
+    }
+    close(fds[1]);
+    size_t got = 0;
+    while (got < sizeof(m))
+    {
+        const ssize_t n = read(fds[0], (char*) &m + got, sizeof(m) - got);
+        if (n <= 0) break;
+        got += n;
+    }
+    close(fds[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    if (got != sizeof(m))
+    {
+        m = Measurement{};
+        strcpy(m.error, "The benchmark process died");
+    }
+#endif
+    return m;
+}
+
+/**
+ * Gets the live cells of a game, by their location on the starting board.
+ */
+static vector<pair<int, int>> live(const GoL& app)
+{
+    BitBoard board;
+    app.store(board);
+    vector<pair<int, int>> found;
+    for (int i = 0; i != board.getLines(); ++i)
+        for (int j = 0; j != board.getColumns(); ++j)
+            if (board.get(i, j)) found.emplace_back(board.getOriginLine() + i, board.getOriginColumn() + j);
+    return found;
+}
+
+/**
+ * Runs a game and the reference side by side, comparing the cells after each run()
+ * (or after each forward() of growing steps if jump).
+ * @return The first difference, empty if none.
+ */
+static string verify(const Config& config, const BitBoard& start, const Rule& rule, const bool& jump,
+                     const int& generations)
+{
+    GoL app;
+    setUp(app, config, start, rule);
+    Reference reference(start, rule, config.mode, generations);
+    // hashlife only shows its viewport onto the plane
+    const bool viewport = config.type == ENGINE_HASHLIFE;
+    int generation = 0;
+    for (int steps = 1; generation < generations; steps = jump ? steps * 2 + 1 : 1)
+    {
+        steps = min(steps, generations - generation);
+        if (jump)
+            app.forward(steps);
+        else
+            app.run();
+        for (int s = 0; s != steps; ++s)
+            reference.step();
+        generation += steps;
+
+        const vector<pair<int, int>> expected = viewport
+                                                ? reference.live(0, 0, start.getLines(), start.getColumns())
+                                                : reference.live();
+        const vector<pair<int, int>> actual = live(app);
+        stringstream s;
+        if (app.getCurrentGeneration() != generation)
+            s << "at generation " << generation << ": the game is at generation " << app.getCurrentGeneration();
+        else if (actual != expected)
+        {
+            vector<pair<int, int>> differ;
+            set_symmetric_difference(actual.begin(), actual.end(), expected.begin(), expected.end(),
+                                     back_inserter(differ));
+            s << "at generation " << generation << ": " << differ.size() << " cells differ, the first at line "
+              << differ[0].first + 1 << " column " << differ[0].second + 1;
+        }
+        else if (!viewport && app.getPopulation() != expected.size())
+            s << "at generation " << generation << ": the population is " << app.getPopulation()
+              << " instead of " << expected.size();
+        if (!s.str().empty()) return s.str();
+    }
+    return "";
+}
+
+/**
+ * Creates a board with each cell alive with a probability.
+ */
+static BitBoard randomBoard(const int& lines, const int& columns, const double& density, const uint64_t& boardSeed)
+{
+    BitBoard board(lines, columns);
+    mt19937_64 generator(boardSeed);
+    board.randomize(0, 0, lines, columns, density, generator);
+    return board;
+}
+
+/**
+ * Loads the patterns of the example directory, sorted by name.
+ */
+static vector<pair<string, BitBoard>> loadExamples(vector<Rule>& rules)
+{
+    vector<string> files;
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((examplesPath + "\\*").c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE) throw runtime_error("Unable to open the example directory " + examplesPath);
+    do
+        files.emplace_back(data.cFileName);
+    while (FindNextFileA(find, &data));
+    FindClose(find);
+#else
+    DIR* dir = opendir(examplesPath.c_str());
+    if (!dir) throw runtime_error("Unable to open the example directory " + examplesPath);
+    while (const dirent* entry = readdir(dir))
+        files.emplace_back(entry->d_name);
+    closedir(dir);
+#endif
+
+    vector<string> names;
+    for (const string& name : files)
+        for (const char* extension : {".txt", ".rle", ".cells"})
+        {
+            const size_t length = strlen(extension);
+            if (name.size() > length && name.compare(name.size() - length, length, extension) == 0)
+                names.push_back(name);
+        }
+    sort(names.begin(), names.end());
+
+    vector<pair<string, BitBoard>> examples;
+    for (const string& name : names)
+    {
+        GoL loader;
+        loader.setVerbose(false).init(examplesPath + "/" + name);
+        BitBoard board;
+        loader.store(board);
+        examples.emplace_back("example/" + name, board);
+        rules.push_back(loader.getRule());
+    }
+    return examples;
+}
+
+static void showHelp()
+{
+    cout << "Usage: gol_bench [--quick] [--seconds={}] [--seed={}] [--examples={}] [--output={}] [--help]" << endl
+         << " quick:    Fewer and shorter cases, for a smoke test." << endl
+         << " seconds:  How long each case is timed, default is 0.5 (0.05 with --quick)." << endl
+         << " seed:     The seed of the random boards, default is 1." << endl
+         << " examples: The directory of the patterns to time, default is the example directory of the sources." << endl
+         << " output:   Write the JSON report to a file instead of the standard output." << endl
+         << "Times run() and forward() of each engine on the example patterns and on random boards, then" << endl
+         << "checks each engine, border mode, thread and process count against a naive stepper. Prints" << endl
+         << "generations and cells per second, the peak resident memory and the history memory of each" << endl
+         << "case as JSON, so that two builds can be compared. Exits with 1 if a check fails." << endl;
+}
+
+int main(int argc, char** argv)
+{
+    bool flSeconds = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const string arg = argv[i];
+        try
+        {
+            if (arg == "--quick")
+                flQuick = true;
+            else if (arg.rfind("--seconds=", 0) == 0)
+            {
+                caseSeconds = stod(arg.substr(10));
+                flSeconds = true;
+            }
+            else if (arg.rfind("--seed=", 0) == 0)
+                seed = stoull(arg.substr(7));
+            else if (arg.rfind("--examples=", 0) == 0)
+                examplesPath = arg.substr(11);
+            else if (arg.rfind("--output=", 0) == 0)
+                outputPath = arg.substr(9);
+            else if (arg == "--help")
+            {
+                showHelp();
+                return 0;
+            }
+            else
+            {
+                cout << "Unknown argument: " << arg << endl;
+                showHelp();
+                return 1;
+            }
+        }
+        catch (const exception&)
+        {
+            cout << "Invalid argument: " << arg << endl;
+            return 1;
+        }
+    }
+    if (flQuick && !flSeconds) caseSeconds = 0.05;
+
+    vector<Config> configs = {
+            {"fixed",     ENGINE_FIXED,     "border",    1, 1},
+            {"fixed",     ENGINE_FIXED,     "noBorder",  1, 1},
+            {"cell",      ENGINE_CELL,      "border",    1, 1},
+            {"cell",      ENGINE_CELL,      "noBorder",  1, 1},
+            {"bitpacked", ENGINE_BITPACKED, "border",    1, 1},
+            {"bitpacked", ENGINE_BITPACKED, "noBorder",  1, 1},
+            {"bitpacked", ENGINE_BITPACKED, "border",    4, 1},
+            {"bitpacked", ENGINE_BITPACKED, "noBorder",  4, 1},
+#ifndef _WIN32
+            {"bitpacked", ENGINE_BITPACKED, "border",    1, 2},
+            {"bitpacked", ENGINE_BITPACKED, "noBorder",  1, 2},
+#endif
+            {"sparse",    ENGINE_SPARSE,    "unbounded", 1, 1},
+            {"hashlife",  ENGINE_HASHLIFE,  "unbounded", 1, 1}
+    };
+    vector<Rule> exampleRules;
+    vector<pair<string, BitBoard>> examples;
+    try
+    {
+        examples = loadExamples(exampleRules);
+    }
+    catch (const exception& e)
+    {
+        cout << e.what() << endl;
+        return 1;
+    }
+
+    // the cases to time: the examples, then random boards by size and density
+    struct Case
+    {
+        string board;
+        BitBoard start;
+        Rule rule;
+        double density; // < 0 for a pattern
+    };
+    vector<Case> cases;
+    for (size_t i = 0; i != examples.size(); ++i)
+        cases.push_back({examples[i].first, examples[i].second, exampleRules[i], -1});
+    vector<int> sizes = {16, 32, 64, 256, 1024};
+    if (flQuick) sizes = {16, 64, 256};
+    for (const int& size : sizes)
+        for (const double& density : {0.1, 0.3, 0.5})
+        {
+            stringstream s;
+            s << "random " << size << "*" << size << " density " << density;
+            cases.push_back({s.str(), randomBoard(size, size, density, seed + cases.size()), Rule(), density});
+        }
+
+    stringstream benchmarks;
+    int measured = 0;
+    for (const Case& c : cases)
+        for (const Config& config : configs)
+        {
+            // without a jump forward() is the same loop of run() as the one timed, so it is only
+            // timed for hashlife and the worker processes; the threads are timed on large boards only
+            if (config.threads > 1 && c.start.getLines() * c.start.getColumns() < 256 * 256) continue;
+            if (!runsOn(config, c.start)) continue;
+            for (const bool& jump : {false, true})
+            {
+                if (jump != (config.type == ENGINE_HASHLIFE || config.processes > 1)) continue;
+                cerr << c.board << ": " << config.engine << " " << config.mode << " threads=" << config.threads
+                     << " processes=" << config.processes << (jump ? " forward" : " run") << endl;
+                const Measurement m = measure(config, c.start, c.rule, jump);
+                const double cells = (double) c.start.getLines() * c.start.getColumns();
+                benchmarks << (measured++ != 0 ? "," : "") << "\n    {\"board\": " << quote(c.board)
+                           << ", \"lines\": " << c.start.getLines() << ", \"columns\": " << c.start.getColumns()
+                           << ", \"rule\": " << quote(c.rule.toString())
+                           << ", \"engine\": " << quote(config.engine) << ", \"mode\": " << quote(config.mode)
+                           << ", \"threads\": " << config.threads << ", \"processes\": " << config.processes
+                           << ", \"method\": " << quote(jump ? "forward" : "run");
+                if (m.error[0])
+                    benchmarks << ", \"error\": " << quote(m.error) << "}";
+                else
+                    benchmarks << ", \"generations\": " << m.generations << ", \"seconds\": " << m.seconds
+                               << ", \"gens_per_sec\": " << (m.seconds > 0 ? m.generations / m.seconds : 0)
+                               << ", \"cells_per_sec\": " << (m.seconds > 0 ? cells * m.generations / m.seconds : 0)
+                               << ", \"peak_rss_bytes\": " << m.peakRss
+                               << ", \"history_bytes\": " << m.historyBytes << "}";
+            }
+        }
+
+    // the boards to check: the examples, and random boards of the fixed-size engines,
+    // of single words, of several words with a partial last one, and of several tiles
+    vector<Case> checks;
+    for (size_t i = 0; i != examples.size(); ++i)
+        checks.push_back({examples[i].first, examples[i].second, exampleRules[i], -1});
+    const int shapes[][2] = {{16, 16}, {37, 45}, {64, 64}, {70, 130}, {150, 200}};
+    const char* rules[] = {"B3/S23", "B36/S23", "B2/S", "B0123478/S01234678"};
+    for (const auto& shape : shapes)
+        for (const char* rule : rules)
+        {
+            stringstream s;
+            s << "random " << shape[0] << "*" << shape[1];
+            checks.push_back({s.str(), randomBoard(shape[0], shape[1], 0.35, seed + checks.size()), Rule::parse(rule), 0.35});
+        }
+    const int generations = flQuick ? 16 : 64;
+
+    stringstream failures;
+    int passed = 0, failed = 0;
+    for (const Case& c : checks)
+        for (const Config& config : configs)
+        {
+            if (c.rule.hasBirthOnZero() && strcmp(config.mode, "unbounded") == 0) continue;
+            if (!runsOn(config, c.start)) continue;
+            for (const bool& jump : {false, true})
+            {
+                string failure;
+                try
+                {
+                    failure = verify(config, c.start, c.rule, jump, generations);
+                }
+                catch (const exception& e)
+                {
+                    failure = e.what();
+                }
+                if (failure.empty())
+                {
+                    ++passed;
+                    continue;
+                }
+                cerr << "FAILED " << c.board << " " << c.rule.toString() << ": " << config.engine << " "
+                     << config.mode << " threads=" << config.threads << " processes=" << config.processes
+                     << (jump ? " forward: " : " run: ") << failure << endl;
+                failures << (failed++ != 0 ? "," : "") << "\n      {\"board\": " << quote(c.board)
+                         << ", \"rule\": " << quote(c.rule.toString()) << ", \"engine\": " << quote(config.engine)
+                         << ", \"mode\": " << quote(config.mode) << ", \"threads\": " << config.threads
+                         << ", \"processes\": " << config.processes
+                         << ", \"method\": " << quote(jump ? "forward" : "run")
+                         << ", \"failure\": " << quote(failure) << "}";
+            }
+        }
+
+    stringstream report;
+    report << "{\n  \"build\": {\"type\": " << quote(GOL_BUILD_TYPE) << ", \"kernel\": " << quote(Kernel::getName())
+#ifdef GOL_STATS
+           << ", \"stats\": true"
+#else
+           << ", \"stats\": false"
+#endif
+           << "},\n  \"settings\": {\"seconds\": " << caseSeconds << ", \"seed\": " << seed
+           << ", \"quick\": " << (flQuick ? "true" : "false") << ", \"check_generations\": " << generations << "}"
+           << ",\n  \"benchmarks\": [" << benchmarks.str() << "\n  ]"
+           << ",\n  \"checks\": {\"passed\": " << passed << ", \"failed\": " << failed
+           << ", \"failures\": [" << failures.str() << (failed != 0 ? "\n    " : "") << "]}\n}" << endl;
+    if (outputPath.empty())
+        cout << report.str();
+    else
+    {
+        ofstream out(outputPath);
+        out << report.str();
+        if (!out)
+        {
+            cout << "Unable to write " << outputPath << endl;
+            return 1;
+        }
+    }
+    cerr << passed << " checks passed, " << failed << " failed" << endl;
+    return failed != 0 ? 1 : 0;
+}
@@ -0,0 +1,110 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include "BatchRunner.h"
+
+using namespace std;
+
+const int BatchRunner::SOUP_SIZE;
+
+BatchRunner& BatchRunner::setEngine(const EngineType& type)
+{
+    engineType = type;
+    return *this;
+}
+
+BatchRunner& BatchRunner::setRule(const Rule& newRule)
+{
+    rule = newRule;
+    return *this;
+}
+
+BatchRunner& BatchRunner::toggleNoBorder(const bool& status)
+{
+    flNoBorder = status;
+    return *this;
+}
+
+BatchRunner& BatchRunner::setStopOnCycle(const bool& status)
+{
+    flStopOnCycle = status;
+    return *this;
+}
+
+BatchRunner& BatchRunner::setThreads(const int& count)
+{
+    if (count < 1) throw runtime_error("Thread number must be >= 1");
+    threads = count;
+    return *this;
+}
+
+BatchRunner& BatchRunner::setTargetGeneration(const int& generation)
+{
+    targetGeneration = generation;
+    return *this;
+}
+
+BatchRunner& BatchRunner::setHashLifeLimit(const size_t& bytes)
+{
+    hashLifeLimit = bytes;
+    return *this;
+}
+
+BitBoard BatchRunner::soup(const uint64_t& seed, const int& lines, const int& columns)
+{
+    BitBoard board(lines, columns);
+    mt19937_64 random(seed);
+    const int height = min(SOUP_SIZE, lines), width = min(SOUP_SIZE, columns);
+    const int top = (lines - height) / 2, left = (columns - width) / 2;
+    for (int i = 0; i != height; ++i)
+    {
+        const uint64_t bits = random(); // SOUP_SIZE <= 64, one draw per line
+        for (int j = 0; j != width; ++j)
+            board.set(top + i, left + j, (bits >> j) & 1);
+    }
+    return board;
+}
+
+vector<BatchResult> BatchRunner::run(const int& count, const function<void(const int&, BitBoard&)>& board) const
+{
+    vector<BatchResult> results((size_t) max(count, 0));
+    mutex failureMutex;
+    exception_ptr failure;
+    ThreadPool pool(threads);
+    pool.parallelFor(count, [&](const int& begin, const int& end) {
+        GoL app;
+        app.setVerbose(false).setEngine(engineType).setThreads(1).setHistoryLimit(0)
+                .setHashLifeLimit(hashLifeLimit).toggleNoBorder(flNoBorder).setRule(rule).setCycleDetection(flStopOnCycle);
+        BitBoard cells;
+        for (int i = begin; i != end; ++i)
+            try
+            {
+                board(i, cells);
+                app.init(cells);
+                if (flStopOnCycle)
+                    while (app.getCurrentGeneration() < targetGeneration && app.getPeriod() == 0)
+                        app.run();
+                else if (targetGeneration > 0)
+                    app.forward(targetGeneration);
+
+                BatchResult& result = results[i];
+                result.generations = app.getCurrentGeneration();
+                result.population = app.getPopulation();
+                result.period = app.getPeriod();
+                result.cycleStart = app.getCycleStart();
+            }
+            catch (...)
+            {
+                lock_guard<mutex> lock(failureMutex);
+                if (!failure) failure = current_exception();
+            }
+    });
+    if (failure) rethrow_exception(failure);
+    return results;
+}
@@ -0,0 +1,85 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_BATCHRUNNER_H
+#define GOL_BATCHRUNNER_H
+
+#include <functional>
+#include <vector>
+#include "GoL.h"
+
+/**
+ * The outcome of one board of a batch.
+ */
+struct BatchResult
+{
+    int generations = 0; // simulated, fewer than the target if the board stopped early
+    uint64_t population = 0;
+    int period = 0; // 1 for a still life, 0 if no cycle was found
+    int cycleStart = 0;
+};
+
+/**
+ * Simulates many independent boards (e.g. random soups) across a thread pool.
+ * Each board is simulated by its own single-threaded GoL on one of the threads,
+ * the threads grab the next board as soon as they are done with one.
+ */
+class BatchRunner
+{
+private:
+    EngineType engineType = ENGINE_BITPACKED;
+    Rule rule;
+    bool flNoBorder = false;
+    bool flStopOnCycle = false;
+    int threads = 1;
+    int targetGeneration = 0;
+    size_t hashLifeLimit = (size_t) 64 << 20; // per board
+
+public:
+    /**
+     * The side of the random area of a soup.
+     */
+    static const int SOUP_SIZE = 16;
+
+    BatchRunner& setEngine(const EngineType& type);
+
+    BatchRunner& setRule(const Rule& newRule);
+
+    BatchRunner& toggleNoBorder(const bool& status);
+
+    /**
+     * Stops a board once it becomes still or periodic, instead of simulating it to the target.
+     */
+    BatchRunner& setStopOnCycle(const bool& status);
+
+    /**
+     * Sets how many boards are simulated at once.
+     */
+    BatchRunner& setThreads(const int& count);
+
+    BatchRunner& setTargetGeneration(const int& generation);
+
+    /**
+     * Sets the memory limit of the hashlife node table of each board.
+     */
+    BatchRunner& setHashLifeLimit(const size_t& bytes);
+
+    /**
+     * Creates a board with a SOUP_SIZE*SOUP_SIZE area of random cells (half of them alive)
+     * in the middle. The same seed always gives the same soup.
+     */
+    static BitBoard soup(const uint64_t& seed, const int& lines, const int& columns);
+
+    /**
+     * Simulates a batch of boards.
+     * @param count The number of boards.
+     * @param board Fills the board of an index, called on the simulating thread.
+     * @return The results by the index of the board.
+     * @throws std::runtime_error if a board fails to initialize or step (e.g. the
+     * rule is not supported by the engine), after the other boards are done.
+     */
+    std::vector<BatchResult> run(const int& count, const std::function<void(const int&, BitBoard&)>& board) const;
+};
+
+#endif //GOL_BATCHRUNNER_H
@@ -0,0 +1,284 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include "BitBoard.h"
+
+using namespace std;
+
+namespace
+{
+    /**
+     * The bits [begin, end) of a word, 0 <= begin < end <= 64.
+     */
+    inline uint64_t rangeMask(const int& begin, const int& end)
+    {
+        return (end == 64 ? ~0ULL : (1ULL << end) - 1) & ~((1ULL << begin) - 1);
+    }
+
+    /**
+     * The 64 cells of a line starting from a column, which may be out of the line (dead).
+     */
+    inline uint64_t window(const uint64_t* line, const int& words, const long& start)
+    {
+        const long w = start >= 0 ? start / 64 : -((-start + 63) / 64);
+        const int shift = (int) (start - w * 64);
+        const uint64_t low = w >= 0 && w < words ? line[w] : 0;
+        const uint64_t high = w + 1 >= 0 && w + 1 < words ? line[w + 1] : 0;
+        return shift == 0 ? low : low >> shift | high << (64 - shift);
+    }
+}
+
+BitBoard::BitBoard(const int& lines, const int& columns)
+{
+    this->lines = lines;
+    this->columns = columns;
+    this->wordsPerLine = (columns + 63) / 64;
+    words.assign((size_t) lines * wordsPerLine, 0);
+}
+
+int BitBoard::getLines() const
+{
+    return lines;
+}
+
+int BitBoard::getColumns() const
+{
+    return columns;
+}
+
+int BitBoard::getOriginLine() const
+{
+    return originLine;
+}
+
+int BitBoard::getOriginColumn() const
+{
+    return originColumn;
+}
+
+void BitBoard::setOrigin(const int& line, const int& column)
+{
+    originLine = line;
+    originColumn = column;
+}
+
+int BitBoard::getWordsPerLine() const
+{
+    return wordsPerLine;
+}
+
+uint64_t BitBoard::getTailMask() const
+{
+    return columns % 64 == 0 ? ~0ULL : (1ULL << (columns % 64)) - 1;
+}
+
+bool BitBoard::get(const int& line, const int& column) const
+{
+    return (words[(size_t) line * wordsPerLine + column / 64] >> (column % 64)) & 1ULL;
+}
+
+void BitBoard::set(const int& line, const int& column, const bool& alive)
+{
+    uint64_t& w = words[(size_t) line * wordsPerLine + column / 64];
+    if (alive)
+        w |= 1ULL << (column % 64);
+    else
+        w &= ~(1ULL << (column % 64));
+}
+
+uint64_t* BitBoard::line(const int& line)
+{
+    return words.data() + (size_t) line * wordsPerLine;
+}
+
+const uint64_t* BitBoard::line(const int& line) const
+{
+    return words.data() + (size_t) line * wordsPerLine;
+}
+
+std::vector<uint64_t>& BitBoard::getWords()
+{
+    return words;
+}
+
+const std::vector<uint64_t>& BitBoard::getWords() const
+{
+    return words;
+}
+
+void BitBoard::clear()
+{
+    for (uint64_t& w : words)
+        w = 0;
+}
+
+uint64_t BitBoard::population() const
+{
+    uint64_t n = 0;
+    for (const uint64_t& w : words)
+        n += __builtin_popcountll(w);
+    return n;
+}
+
+bool BitBoard::boundingBox(int& top, int& left, int& bottom, int& right) const
+{
+    top = -1;
+    uint64_t first = 0, last = 0; // the columns in use of the first and the last word of all lines
+    int firstWord = wordsPerLine, lastWord = -1;
+    for (int i = 0; i != lines; ++i)
+    {
+        const uint64_t* l = line(i);
+        for (int w = 0; w != wordsPerLine; ++w)
+        {
+            if (!l[w]) continue;
+            if (top < 0) top = i;
+            bottom = i + 1;
+            if (w < firstWord)
+            {
+                firstWord = w;
+                first = 0;
+            }
+            if (w > lastWord)
+            {
+                lastWord = w;
+                last = 0;
+            }
+            if (w == firstWord) first |= l[w];
+            if (w == lastWord) last |= l[w];
+        }
+    }
+    if (top < 0) return false;
+    left = firstWord * 64 + __builtin_ctzll(first);
+    right = lastWord * 64 + 64 - __builtin_clzll(last);
+    return true;
+}
+
+uint64_t BitBoard::hashWord(const int& line, const int& wordColumn, const uint64_t& bits)
+{
+    if (!bits) return 0;
+    // the finalizer of splitmix64 over the cells and a key of the location
+    uint64_t h = bits + (uint64_t) (int64_t) line * 0x9E3779B97F4A7C15ULL + (uint64_t) (int64_t) wordColumn * 0xC2B2AE3D27D4EB4FULL;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
+
+void BitBoard::paste(const BitBoard& source, const int& top, const int& left, const bool& merge)
+{
+    // the far side in 64 bits, the source may land far from this board
+    const int first = max(top, 0), last = (int) min((long long) top + source.lines, (long long) lines);
+    const int begin = max(left, 0), end = (int) min((long long) left + source.columns, (long long) columns);
+    if (first >= last || begin >= end) return;
+    for (int i = first; i != last; ++i)
+    {
+        const uint64_t* from = source.line(i - top);
+        uint64_t* to = line(i);
+        for (int w = begin / 64; w <= (end - 1) / 64; ++w)
+        {
+            const uint64_t mask = rangeMask(max(begin - w * 64, 0), min(end - w * 64, 64));
+            const uint64_t bits = window(from, source.wordsPerLine, (long) w * 64 - left) & mask;
+            to[w] = merge ? to[w] | bits : (to[w] & ~mask) | bits;
+        }
+    }
+}
+
+void BitBoard::fill(const int& top, const int& left, const int& bottom, const int& right, const bool& alive)
+{
+    const int first = max(top, 0), last = min(bottom, lines);
+    const int begin = max(left, 0), end = min(right, columns);
+    if (first >= last || begin >= end) return;
+    for (int i = first; i != last; ++i)
+    {
+        uint64_t* l = line(i);
+        for (int w = begin / 64; w <= (end - 1) / 64; ++w)
+        {
+            const uint64_t mask = rangeMask(max(begin - w * 64, 0), min(end - w * 64, 64));
+            l[w] = alive ? l[w] | mask : l[w] & ~mask;
+        }
+    }
+}
+
+void BitBoard::randomize(const int& top, const int& left, const int& bottom, const int& right,
+                         const double& density, mt19937_64& random)
+{
+    const int first = max(top, 0), last = min(bottom, lines);
+    const int begin = max(left, 0), end = min(right, columns);
+    if (first >= last || begin >= end) return;
+    const int q = (int) (min(max(density, 0.0), 1.0) * 256 + 0.5); // 0 to 256
+    for (int i = first; i != last; ++i)
+    {
+        uint64_t* l = line(i);
+        for (int w = begin / 64; w <= (end - 1) / 64; ++w)
+        {
+            // each bit of q from the lowest halves the probability and adds 1/2 if set,
+            // by an AND or an OR with a random word: q / 256 in the end
+            uint64_t bits = q == 256 ? ~0ULL : 0;
+            for (int k = q == 0 || q == 256 ? 8 : __builtin_ctz(q); k != 8; ++k)
+                bits = (q >> k) & 1 ? bits | random() : bits & random();
+            const uint64_t mask = rangeMask(max(begin - w * 64, 0), min(end - w * 64, 64));
+            l[w] = (l[w] & ~mask) | (bits & mask);
+        }
+    }
+}
+
+BitBoard BitBoard::transformed(const int& symmetry) const
+{
+    const bool turned = symmetry & 1;
+    BitBoard result(turned ? columns : lines, turned ? lines : columns);
+    result.setOrigin(originLine, originColumn);
+    for (int i = 0; i != lines; ++i)
+    {
+        const uint64_t* l = line(i);
+        for (int w = 0; w != wordsPerLine; ++w)
+            for (uint64_t bits = l[w]; bits; bits &= bits - 1)
+            {
+                const int j = w * 64 + __builtin_ctzll(bits);
+                const int x = symmetry & 4 ? columns - 1 - j : j;
+                switch (symmetry & 3)
+                {
+                    case 0:
+                        result.set(i, x, true);
+                        break;
+                    case 1:
+                        result.set(x, lines - 1 - i, true);
+                        break;
+                    case 2:
+                        result.set(lines - 1 - i, columns - 1 - x, true);
+                        break;
+                    default:
+                        result.set(columns - 1 - x, i, true);
+                }
+            }
+    }
+    return result;
+}
+
+uint64_t BitBoard::hash() const
+{
+    uint64_t h = 0;
+    for (int i = 0; i != lines; ++i)
+    {
+        const uint64_t* l = line(i);
+        for (int w = 0; w != wordsPerLine; ++w)
+            h ^= hashWord(i, w, l[w]);
+    }
+    return h;
+}
+
+bool BitBoard::sameSizeAs(const BitBoard& other) const
+{
+    return lines == other.lines && columns == other.columns
+           && originLine == other.originLine && originColumn == other.originColumn;
+}
+
+bool BitBoard::operator ==(const BitBoard& other) const
+{
+    return sameSizeAs(other) && words == other.words;
+}
+
+bool BitBoard::operator !=(const BitBoard& other) const
+{
+    return !(*this == other);
+}
@@ -0,0 +1,137 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_BITBOARD_H
+#define GOL_BITBOARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * A bit-packed cell board. Each line is stored as a run of 64-bit words,
+ * column j of a line is bit (j % 64) of word (j / 64).
+ * <br>
+ * The padding bits after the last column of each line are always 0.
+ * The border is not stored, all locations are 0-based. A board cut from
+ * an unbounded universe also remembers where its top-left corner was.
+ */
+class BitBoard
+{
+private:
+    int lines = 0, columns = 0, wordsPerLine = 0;
+    int originLine = 0, originColumn = 0;
+    std::vector<uint64_t> words;
+public:
+    BitBoard() = default;
+
+    /**
+     * Creates an empty (all dead) board.
+     */
+    BitBoard(const int& lines, const int& columns);
+
+    int getLines() const;
+
+    int getColumns() const;
+
+    /**
+     * Gets the location of the top-left corner in the universe, 0 unless cut from an unbounded universe.
+     */
+    int getOriginLine() const;
+
+    int getOriginColumn() const;
+
+    void setOrigin(const int& line, const int& column);
+
+    /**
+     * How many 64-bit words does a line take?
+     */
+    int getWordsPerLine() const;
+
+    /**
+     * The mask of the valid bits in the last word of each line.
+     */
+    uint64_t getTailMask() const;
+
+    bool get(const int& line, const int& column) const;
+
+    void set(const int& line, const int& column, const bool& alive);
+
+    uint64_t* line(const int& line);
+
+    const uint64_t* line(const int& line) const;
+
+    std::vector<uint64_t>& getWords();
+
+    const std::vector<uint64_t>& getWords() const;
+
+    /**
+     * Kills all cells.
+     */
+    void clear();
+
+    /**
+     * Counts the live cells.
+     */
+    uint64_t population() const;
+
+    /**
+     * Finds the bounding box of the live cells, bottom and right excluded.
+     * @return false if there is no live cell.
+     */
+    bool boundingBox(int& top, int& left, int& bottom, int& right) const;
+
+    /**
+     * Copies the cells of another board onto this one a word at a time, the top-left cell
+     * of the source landing at a location which may be out of this board. The cells which
+     * land out of this board are dropped.
+     * @param source Another board.
+     * @param merge Keep the live cells under the dead cells of the source instead of killing them.
+     */
+    void paste(const BitBoard& source, const int& top, const int& left, const bool& merge);
+
+    /**
+     * Sets all cells of a rectangle a word at a time, bottom and right excluded.
+     * The part out of the board is ignored.
+     */
+    void fill(const int& top, const int& left, const int& bottom, const int& right, const bool& alive);
+
+    /**
+     * Sets each cell of a rectangle alive with a probability (rounded to 1/256) and dead
+     * otherwise, a word at a time, bottom and right excluded. The part out of the board is ignored.
+     */
+    void randomize(const int& top, const int& left, const int& bottom, const int& right,
+                   const double& density, std::mt19937_64& random);
+
+    /**
+     * Gets a copy flipped and/or rotated, keeping the origin.
+     * @param symmetry 0-7, flipped left to right first if bit 2 is set, then rotated
+     * by 90 degrees clockwise (symmetry & 3) times.
+     */
+    BitBoard transformed(const int& symmetry) const;
+
+    /**
+     * Hashes a word of cells at a location, 0 if all cells in it are dead. The hash of a board
+     * is the XOR of the hashes of all its words, so it can be updated word by word.
+     * @param wordColumn The column of the first cell of the word divided by 64.
+     */
+    static uint64_t hashWord(const int& line, const int& wordColumn, const uint64_t& bits);
+
+    /**
+     * Hashes the cells, the origin is not included.
+     */
+    uint64_t hash() const;
+
+    /**
+     * Checks if both boards have the same size and origin.
+     */
+    bool sameSizeAs(const BitBoard& other) const;
+
+    bool operator ==(const BitBoard& other) const;
+
+    bool operator !=(const BitBoard& other) const;
+};
+
+#endif //GOL_BITBOARD_H
@@ -0,0 +1,279 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include "BitEngine.h"
+#include "Kernel.h"
+
+const int BitEngine::TILE_LINES;
+
+void BitEngine::init(const int& initLines, const int& initColumns)
+{
+    kernel = Kernel::get(rule);
+    current = BitBoard(initLines, initColumns);
+    next = BitBoard(initLines, initColumns);
+    zeroLine.assign(current.getWordsPerLine(), 0);
+    tileRows = (initLines + TILE_LINES - 1) / TILE_LINES;
+    tileColumns = current.getWordsPerLine();
+    changed.assign((size_t) tileRows * tileColumns, 1); // an empty board is not stable under B0 rules
+    active.assign((size_t) tileRows * tileColumns, 0);
+    activeTiles = 0;
+    hash = 0;
+    rowHashes.assign(tileRows, 0);
+    rowBirths.assign(tileRows, 0);
+    rowDeaths.assign(tileRows, 0);
+    tilePopulations.assign((size_t) tileRows * tileColumns, 0);
+    population = 0;
+    hasLife = false;
+}
+
+int BitEngine::getLines() const
+{
+    return current.getLines();
+}
+
+int BitEngine::getColumns() const
+{
+    return current.getColumns();
+}
+
+CellState BitEngine::getStateOf(const int& line, const int& column) const
+{
+    return current.get(line, column) ? STATE_ALIVE : STATE_DEAD;
+}
+
+void BitEngine::setStateOf(const int& line, const int& column, const CellState& state)
+{
+    const uint64_t before = current.line(line)[column / 64];
+    current.set(line, column, state == STATE_ALIVE);
+    const uint64_t after = current.line(line)[column / 64];
+    if (before == after) return;
+    const size_t tile = (size_t) (line / TILE_LINES) * tileColumns + column / 64;
+    hash ^= BitBoard::hashWord(line, column / 64, before) ^ BitBoard::hashWord(line, column / 64, after);
+    changed[tile] = 1;
+    if (state != STATE_ALIVE)
+    {
+        --population;
+        --tilePopulations[tile];
+        if (line == top || line == bottom - 1 || column == left || column == right - 1)
+            measure();
+        return;
+    }
+    ++population;
+    ++tilePopulations[tile];
+    if (!hasLife)
+    {
+        top = line;
+        left = column;
+        bottom = line + 1;
+        right = column + 1;
+        hasLife = true;
+    }
+    else
+    {
+        top = std::min(top, line);
+        left = std::min(left, column);
+        bottom = std::max(bottom, line + 1);
+        right = std::max(right, column + 1);
+    }
+}
+
+void BitEngine::setNoBorder(const bool& status)
+{
+    flNoBorder = status;
+    touchAll(); // the tiles on the edges get new neighbours
+}
+
+void BitEngine::setRule(const Rule& newRule)
+{
+    rule = newRule;
+    kernel = Kernel::get(rule);
+    touchAll(); // the stable tiles may change under the new rule
+}
+
+void BitEngine::touchAll()
+{
+    for (uint8_t& c : changed)
+        c = 1;
+}
+
+void BitEngine::step()
+{
+    // a tile needs recalculating if itself or any of its 8 neighbours changed
+    activeTiles = 0;
+    for (int r = 0; r != tileRows; ++r)
+        for (int c = 0; c != tileColumns; ++c)
+        {
+            uint8_t a = 0;
+            for (int dr = -1; dr <= 1 && !a; ++dr)
+                for (int dc = -1; dc <= 1 && !a; ++dc)
+                {
+                    int nr = r + dr, nc = c + dc;
+                    if (flNoBorder)
+                    {
+                        nr = (nr + tileRows) % tileRows;
+                        nc = (nc + tileColumns) % tileColumns;
+                    }
+                    else if (nr < 0 || nr >= tileRows || nc < 0 || nc >= tileColumns)
+                        continue;
+                    a = changed[(size_t) nr * tileColumns + nc];
+                }
+            active[(size_t) r * tileColumns + c] = a;
+            activeTiles += a;
+        }
+
+    parallelFor(tileRows, [this](const int& begin, const int& end) {
+        for (int r = begin; r != end; ++r)
+            stepTileRow(r);
+    });
+    std::swap(current, next);
+    for (const uint64_t& h : rowHashes)
+        hash ^= h;
+    evaluatedCells = (uint64_t) activeTiles * TILE_LINES * 64;
+    births = deaths = 0;
+    for (int r = 0; r != tileRows; ++r)
+    {
+        births += rowBirths[r];
+        deaths += rowDeaths[r];
+    }
+    population += births - deaths;
+    if (births != 0 || deaths != 0) measure();
+}
+
+void BitEngine::measure()
+{
+    // the rows and the columns of the tiles with live cells
+    int firstRow = tileRows, lastRow = -1, firstColumn = tileColumns, lastColumn = -1;
+    for (int r = 0; r != tileRows; ++r)
+        for (int c = 0; c != tileColumns; ++c)
+            if (tilePopulations[(size_t) r * tileColumns + c])
+            {
+                firstRow = std::min(firstRow, r);
+                lastRow = r;
+                firstColumn = std::min(firstColumn, c);
+                lastColumn = std::max(lastColumn, c);
+            }
+    hasLife = lastRow >= 0;
+    if (!hasLife) return;
+
+    // then the cells in the tiles on the edges
+    auto empty = [&](const int& i) {
+        const uint64_t* l = current.line(i);
+        for (int w = firstColumn; w <= lastColumn; ++w)
+            if (l[w]) return false;
+        return true;
+    };
+    top = firstRow * TILE_LINES;
+    while (empty(top)) ++top;
+    bottom = std::min(getLines(), (lastRow + 1) * TILE_LINES);
+    while (empty(bottom - 1)) --bottom;
+    uint64_t first = 0, last = 0;
+    for (int i = top; i != bottom; ++i)
+    {
+        first |= current.line(i)[firstColumn];
+        last |= current.line(i)[lastColumn];
+    }
+    left = firstColumn * 64 + __builtin_ctzll(first);
+    right = lastColumn * 64 + 64 - __builtin_clzll(last);
+}
+
+void BitEngine::stepTileRow(const int& row)
+{
+    const int lines = getLines();
+    const int first = row * TILE_LINES, last = std::min(lines, first + TILE_LINES);
+    const uint8_t* a = active.data() + (size_t) row * tileColumns;
+    uint8_t* c = changed.data() + (size_t) row * tileColumns;
+    uint32_t* p = tilePopulations.data() + (size_t) row * tileColumns;
+    uint64_t& h = rowHashes[row];
+    uint64_t& born = rowBirths[row];
+    uint64_t& died = rowDeaths[row];
+    h = born = died = 0;
+
+    for (int w = 0; w != tileColumns;)
+    {
+        if (!a[w])
+        {
+            c[w++] = 0;
+            continue;
+        }
+        // calculate a run of active tiles at once to keep the kernel busy
+        int end = w;
+        while (end != tileColumns && a[end]) ++end;
+        for (int i = first; i != last; ++i)
+        {
+            const uint64_t* up = i != 0 ? current.line(i - 1) :
+                                 flNoBorder ? current.line(lines - 1) : zeroLine.data();
+            const uint64_t* down = i != lines - 1 ? current.line(i + 1) :
+                                   flNoBorder ? current.line(0) : zeroLine.data();
+            Kernel::line(kernel, up, current.line(i), down, next.line(i), w, end, getColumns(), flNoBorder, rule);
+        }
+        for (; w != end; ++w)
+        {
+            uint64_t diff = 0, tileBorn = 0, tileDied = 0;
+            for (int i = first; i != last; ++i)
+            {
+                const uint64_t before = current.line(i)[w], after = next.line(i)[w];
+                if (before == after) continue;
+                diff = 1;
+                h ^= BitBoard::hashWord(i, w, before) ^ BitBoard::hashWord(i, w, after);
+                tileBorn += __builtin_popcountll(after & ~before);
+                tileDied += __builtin_popcountll(before & ~after);
+            }
+            c[w] = diff != 0;
+            p[w] += (uint32_t) (tileBorn - tileDied);
+            born += tileBorn;
+            died += tileDied;
+        }
+    }
+}
+
+void BitEngine::store(BitBoard& board) const
+{
+    board = current;
+}
+
+void BitEngine::load(const BitBoard& board)
+{
+    current = board;
+    next = board;
+    hash = board.hash();
+    population = 0;
+    for (int r = 0; r != tileRows; ++r)
+        for (int c = 0; c != tileColumns; ++c)
+        {
+            uint32_t n = 0;
+            for (int i = r * TILE_LINES; i != std::min(getLines(), (r + 1) * TILE_LINES); ++i)
+                n += __builtin_popcountll(current.line(i)[c]);
+            tilePopulations[(size_t) r * tileColumns + c] = n;
+            population += n;
+        }
+    measure();
+    touchAll();
+}
+
+uint64_t BitEngine::getHash() const
+{
+    return hash;
+}
+
+void BitEngine::getTileStats(long& activeCount, long& total) const
+{
+    activeCount = activeTiles;
+    total = (long) tileRows * tileColumns;
+}
+
+uint64_t BitEngine::getPopulation() const
+{
+    return population;
+}
+
+bool BitEngine::getBoundingBox(int& boxTop, int& boxLeft, int& boxBottom, int& boxRight) const
+{
+    if (!hasLife) return false;
+    boxTop = top;
+    boxLeft = left;
+    boxBottom = bottom;
+    boxRight = right;
+    return true;
+}
@@ -0,0 +1,92 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_BITENGINE_H
+#define GOL_BITENGINE_H
+
+#include "Engine.h"
+#include "Kernel.h"
+
+/**
+ * The bit-packed engine. The board is stored as 64-cell machine words,
+ * and a whole word of cells is stepped at once by adding up the 8 shifted
+ * neighbour words with bitwise full adders. The inner words of a line are
+ * handed to a vector kernel selected for the CPU, see Kernel.
+ * <br>
+ * The board is split into tiles of 64 columns (one word) * 32 lines, and
+ * only the tiles which changed in the last step or border such a tile are
+ * recalculated. The others cannot change, so they are skipped.
+ * <br>
+ * The population of each tile is updated from the words which changed, and
+ * the bounding box of the live cells is found from the tiles after each step.
+ */
+class BitEngine : public Engine
+{
+public:
+    static const int TILE_LINES = 32;
+
+private:
+    bool flNoBorder = false;
+    BitBoard current, next; // a skipped tile is the same in both
+    std::vector<uint64_t> zeroLine; // the dead line outside the top and bottom border
+    Kernel::LineFunction kernel = nullptr; // steps the inner words of a line
+    int tileRows = 0, tileColumns = 0;
+    std::vector<uint8_t> changed; // the tiles changed in the last step (or edited since)
+    std::vector<uint8_t> active; // the tiles to recalculate in this step
+    long activeTiles = 0;
+    uint64_t hash = 0; // the hash of the current board
+    std::vector<uint64_t> rowHashes; // how each row of tiles changed the hash in the last step
+    std::vector<uint64_t> rowBirths, rowDeaths; // in each row of tiles in the last step
+    std::vector<uint32_t> tilePopulations;
+    uint64_t population = 0;
+    bool hasLife = false;
+    int top = 0, left = 0, bottom = 0, right = 0; // the bounding box of the live cells, bottom and right excluded
+
+    /**
+     * Recalculates the active tiles in a row of tiles, finds out which of them changed
+     * and how the changed words change the hash.
+     */
+    void stepTileRow(const int& row);
+
+    /**
+     * Finds the bounding box of the live cells from the populations of the tiles.
+     */
+    void measure();
+
+    /**
+     * Marks all tiles as changed, so that the whole board is recalculated in the next step.
+     */
+    void touchAll();
+
+public:
+    void init(const int& initLines, const int& initColumns) override;
+
+    int getLines() const override;
+
+    int getColumns() const override;
+
+    CellState getStateOf(const int& line, const int& column) const override;
+
+    void setStateOf(const int& line, const int& column, const CellState& state) override;
+
+    void setNoBorder(const bool& status) override;
+
+    void setRule(const Rule& newRule) override;
+
+    void step() override;
+
+    void store(BitBoard& board) const override;
+
+    void load(const BitBoard& board) override;
+
+    uint64_t getHash() const override;
+
+    void getTileStats(long& activeCount, long& total) const override;
+
+    uint64_t getPopulation() const override;
+
+    bool getBoundingBox(int& boxTop, int& boxLeft, int& boxBottom, int& boxRight) const override;
+};
+
+#endif //GOL_BITENGINE_H
@@ -0,0 +1,158 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "BoardFile.h"
+
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+using namespace std;
+
+namespace
+{
+    const char MAGIC[4] = {'G', 'O', 'L', 'B'};
+    const uint32_t VERSION = 2; // 1 had no rule
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        int32_t lines, columns;
+        int32_t originLine, originColumn;
+        uint16_t birth, survival; // the rule, 0 in version 1
+        uint32_t reserved;
+        uint64_t generation;
+        uint64_t checksum; // of the words
+    };
+
+    uint64_t checksum(const vector<uint64_t>& words)
+    {
+        uint64_t h = 0xCBF29CE484222325ULL;
+        for (const uint64_t& w : words)
+            h = (h ^ w) * 0x100000001B3ULL;
+        return h;
+    }
+
+    /**
+     * Checks the header and gets the size of the words following it.
+     */
+    size_t payloadBytes(const Header& header, const string& path)
+    {
+        if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+            throw runtime_error(string("Not a binary board file: ").append(path));
+        if (header.version < 1 || header.version > VERSION)
+            throw runtime_error(string("Unsupported binary board version ").append(to_string(header.version)));
+        // rounded up to whole words in int, like BitBoard does
+        if (header.lines < 0 || header.columns < 0 || header.columns > INT32_MAX - 63)
+            throw runtime_error(string("Corrupted binary board file: ").append(path));
+        return (size_t) header.lines * (size_t) ((header.columns + 63) / 64) * sizeof(uint64_t);
+    }
+
+    void truncated(const string& path)
+    {
+        throw runtime_error(string("Truncated binary board file: ").append(path));
+    }
+}
+
+bool BoardFile::isBinary(const string& path)
+{
+    ifstream in(path, ios::binary);
+    char magic[sizeof(MAGIC)];
+    return in.read(magic, sizeof(magic)) && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool BoardFile::hasBinaryExtension(const string& path)
+{
+    return path.size() >= 5 && path.compare(path.size() - 5, 5, ".golb") == 0;
+}
+
+void BoardFile::read(const string& path, BitBoard& board, long& generation, Rule& rule)
+{
+    Header header;
+#ifdef _WIN32
+    ifstream in(path, ios::binary);
+    if (!in) throw runtime_error(string("Unable to read input file: ").append(path));
+    if (!in.read((char*) &header, sizeof(header))) truncated(path);
+    const size_t bytes = payloadBytes(header, path);
+    board = BitBoard(header.lines, header.columns);
+    if (!in.read((char*) board.getWords().data(), (streamsize) bytes)) truncated(path);
+    in.close();
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw runtime_error(string("Unable to read input file: ").append(path));
+    struct stat status = {};
+    if (fstat(fd, &status) != 0 || (size_t) status.st_size < sizeof(header))
+    {
+        close(fd);
+        truncated(path);
+    }
+    const size_t length = (size_t) status.st_size;
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) throw runtime_error(string("Unable to map input file: ").append(path));
+    madvise(mapped, length, MADV_SEQUENTIAL);
+
+    memcpy(&header, mapped, sizeof(header));
+    size_t bytes;
+    try
+    {
+        bytes = payloadBytes(header, path);
+        if (length - sizeof(header) < bytes) truncated(path);
+    }
+    catch (...)
+    {
+        munmap(mapped, length);
+        throw;
+    }
+    board = BitBoard(header.lines, header.columns);
+    memcpy(board.getWords().data(), (const char*) mapped + sizeof(header), bytes);
+    munmap(mapped, length);
+#endif
+
+    if (checksum(board.getWords()) != header.checksum)
+        throw runtime_error(string("Checksum mismatch in binary board file: ").append(path));
+    // the engines expect the bits after the last column to be dead
+    const int last = board.getWordsPerLine() - 1;
+    for (int i = 0; i != board.getLines(); ++i)
+        if (board.line(i)[last] & ~board.getTailMask())
+            throw runtime_error(string("Cells after the last column in binary board file: ").append(path));
+    // the generations are counted in int
+    if (header.generation > (uint64_t) INT32_MAX)
+        throw runtime_error(string("Generation out of range in binary board file: ").append(path));
+    board.setOrigin(header.originLine, header.originColumn);
+    generation = (long) header.generation;
+    if (header.version >= 2) rule = Rule(header.birth, header.survival);
+}
+
+bool BoardFile::write(const string& path, const BitBoard& board, const long& generation, const Rule& rule)
+{
+    Header header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.lines = board.getLines();
+    header.columns = board.getColumns();
+    header.originLine = board.getOriginLine();
+    header.originColumn = board.getOriginColumn();
+    header.birth = rule.getBirth();
+    header.survival = rule.getSurvival();
+    header.generation = (uint64_t) generation;
+    header.checksum = checksum(board.getWords());
+
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) return false;
+    out.write((const char*) &header, sizeof(header));
+    out.write((const char*) board.getWords().data(), (streamsize) (board.getWords().size() * sizeof(uint64_t)));
+    out.close();
+    return !out.fail();
+}
@@ -0,0 +1,53 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_BOARDFILE_H
+#define GOL_BOARDFILE_H
+
+#include <string>
+#include "BitBoard.h"
+#include "Rule.h"
+
+/**
+ * Reads and writes the binary board format (.golb).
+ * <br>
+ * A file is a 48-byte header followed by the words of a BitBoard exactly as
+ * they are in memory (little-endian, line by line, padded to 64 bits). The
+ * header holds the magic "GOLB", the format version, the size and the origin
+ * of the board, the rule (since version 2), the generation and a checksum of
+ * the words. Loading maps the file into memory and copies the words without
+ * parsing any cell.
+ */
+class BoardFile
+{
+public:
+    /**
+     * Checks if a file starts with the magic of the binary format.
+     * @return false if the file can not be read or is a text file.
+     */
+    static bool isBinary(const std::string& path);
+
+    /**
+     * Checks if a file name has the extension of the binary format.
+     */
+    static bool hasBinaryExtension(const std::string& path);
+
+    /**
+     * Loads a board from a binary file.
+     * @param generation Receives the generation the board was saved at.
+     * @param rule Receives the rule the board was simulated with, unchanged for version 1 files.
+     * @throws std::runtime_error if the file can not be read, has an unsupported
+     * version, is truncated, fails the checksum, has live cells after the last column
+     * or a generation above INT_MAX.
+     */
+    static void read(const std::string& path, BitBoard& board, long& generation, Rule& rule);
+
+    /**
+     * Saves a board to a binary file, replacing it if exists.
+     * @return false if the file can not be written.
+     */
+    static bool write(const std::string& path, const BitBoard& board, const long& generation, const Rule& rule);
+};
+
+#endif //GOL_BOARDFILE_H
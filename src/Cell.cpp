@@ -3,18 +3,11 @@
 //
 
 #include "Cell.h"
+#include "CommonUtil.h"
 
 std::string Cell::toString() const
 {
-#ifdef _WIN32
-    return state == STATE_BORDER ? "##" :
-           state == STATE_DEAD ? ". "
-                               : "[]";
-#else
-    return state == STATE_BORDER ? "囗" :
-           state == STATE_DEAD ? "丶"
-                               : "回";
-#endif
+    return CommonUtil::toString(state);
 }
 
 Cell::Cell(const CellState& state)
@@ -45,25 +38,11 @@ void Cell::setNextState(const CellState& newState)
 
 char Cell::toChar() const
 {
-    return state == STATE_BORDER ? '#' :
-           state == STATE_DEAD ? '0' :
-           '1';
+    return CommonUtil::toChar(state);
 }
 
-CellState Cell::calculateNextState() const
+CellState Cell::calculateNextState(const int& live, const Rule& rule) const
 {
     if (state == STATE_BORDER) return STATE_BORDER;
-    int live = 0;
-    for (const auto& c : neighbours)
-        if (c->getState() == STATE_ALIVE) ++live;
-    return live == 3 || (state == STATE_ALIVE && live == 2) ? STATE_ALIVE : STATE_DEAD;
-}
-
-Cell& Cell::setNeighbour(Cell* c)
-{
-    static unsigned char i = 0;
-    i %= 8;
-    neighbours[i] = c;
-    ++i;
-    return *this;
+    return rule.next(state == STATE_ALIVE, live) ? STATE_ALIVE : STATE_DEAD;
 }
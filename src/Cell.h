@@ -6,6 +6,7 @@
 #define GOL_CELL_H
 
 #include "CellState.h"
+#include "Rule.h"
 #include <string>
 
 /**
@@ -18,7 +19,6 @@ class Cell
 private:
     CellState state = STATE_BORDER;
     CellState nextState = STATE_BORDER;
-    Cell* neighbours[8] = {};
 public:
     Cell() = default;
 
@@ -47,31 +47,12 @@ public:
 
     /**
      * Calculates the next state of the cell based on the states of the surrounding 8 cells.
-     * @return
-     * STATE_BORDER if:
-     * <ul>
-     * <li> the current state of the cell is STATE_BORDER </li>
-     * </ul>
-     * STATE_ALIVE if:
-     * <ul>
-     * <li> the cell is surrounded by 3 live cells </li>
-     * <li> or the cell is live and surrounded by 2 live cells </li>
-     * </ul>
-     * STATE_DEAD if:
-     * <ul>
-     * <li> none of the above conditions are met </li>
-     * </ul>
+     * @param live How many of the surrounding 8 cells are alive.
+     * @param rule The rule deciding whether the cell is born or survives.
+     * @return STATE_BORDER if the current state of the cell is STATE_BORDER, otherwise
+     * the state given by the rule.
      */
-    CellState calculateNextState() const;
-
-    /**
-     * Sets the neighbors of a cell.
-     * <br>
-     * This function must be called 8 times in a row when setting the neighbors
-     * of a cell, otherwise all subsequent operations of other cells will go wrong.
-     * @param c The pointer to a neighbour cell.
-     */
-    Cell& setNeighbour(Cell* c);
+    CellState calculateNextState(const int& live, const Rule& rule) const;
 };
 
 #endif //GOL_CELL_H
@@ -0,0 +1,266 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include <mutex>
+#include "CellEngine.h"
+
+using namespace std;
+
+void CellEngine::init(const int& initLines, const int& initColumns)
+{
+    // add a border with the width of 1 cell
+    lines = initLines + 2;
+    columns = initColumns + 2;
+
+    cells = vector<vector<Cell>>(lines);
+    for (int i = 0; i != lines; ++i)
+        for (int j = 0; j != columns; ++j)
+            if (i == 0 || i == lines - 1)
+                cells[i].emplace_back(STATE_BORDER);
+            else
+                cells[i].emplace_back(j == 0 || j == columns - 1 ? STATE_BORDER : STATE_DEAD);
+    population = 0;
+    hasLife = false;
+}
+
+int CellEngine::getLines() const
+{
+    return lines - 2;
+}
+
+int CellEngine::getColumns() const
+{
+    return columns - 2;
+}
+
+CellState CellEngine::getStateOf(const int& line, const int& column) const
+{
+    return cells[line + 1][column + 1].getState();
+}
+
+void CellEngine::setStateOf(const int& line, const int& column, const CellState& state)
+{
+    Cell& c = cells[line + 1][column + 1];
+    if (c.getState() == state) return;
+    c.setState(state);
+    if (state == STATE_ALIVE)
+    {
+        ++population;
+        expand(line, column);
+    }
+    else if (line == top || line == bottom - 1 || column == left || column == right - 1)
+        measure(); // the box may shrink
+    else
+        --population;
+}
+
+void CellEngine::setNoBorder(const bool& status)
+{
+    flNoBorder = status;
+    if (!cells.empty() && !status)
+        resetBorder();
+}
+
+void CellEngine::step()
+{
+    // only the live cells and their neighbours can change, unless the border wraps or dead cells are born alone
+    if (flNoBorder || rule.hasBirthOnZero())
+    {
+        regionTop = regionLeft = 0;
+        regionBottom = getLines();
+        regionRight = getColumns();
+    }
+    else if (!hasLife)
+    {
+        evaluatedCells = births = deaths = 0;
+        return;
+    }
+    else
+    {
+        regionTop = max(0, top - 1);
+        regionLeft = max(0, left - 1);
+        regionBottom = min(getLines(), bottom + 1);
+        regionRight = min(getColumns(), right + 1);
+    }
+
+    if (flNoBorder) wrapBorder();
+    {
+        GOL_PHASE(stats, PHASE_CALCULATE);
+        calculateNextGeneration();
+    }
+    {
+        GOL_PHASE(stats, PHASE_APPLY);
+        applyNextGeneration();
+    }
+    evaluatedCells = (uint64_t) (regionBottom - regionTop) * (regionRight - regionLeft);
+}
+
+void CellEngine::calculateNextGeneration()
+{
+    const int offset = regionTop, first = regionLeft + 1, last = regionRight;
+    parallelFor(regionBottom - regionTop, [&](const int& begin, const int& end) {
+        for (int i = offset + begin + 1; i <= offset + end; ++i)
+        {
+            const Cell* up = cells[i - 1].data();
+            const Cell* down = cells[i + 1].data();
+            Cell* mid = cells[i].data();
+            for (int j = first; j <= last; ++j)
+            {
+                const int live = (up[j - 1].getState() == STATE_ALIVE) + (up[j].getState() == STATE_ALIVE)
+                                 + (up[j + 1].getState() == STATE_ALIVE) + (mid[j - 1].getState() == STATE_ALIVE)
+                                 + (mid[j + 1].getState() == STATE_ALIVE) + (down[j - 1].getState() == STATE_ALIVE)
+                                 + (down[j].getState() == STATE_ALIVE) + (down[j + 1].getState() == STATE_ALIVE);
+                mid[j].setNextState(mid[j].calculateNextState(live, rule));
+            }
+        }
+    });
+}
+
+void CellEngine::applyNextGeneration()
+{
+    // the cells outside the region are dead, so the live cells in it make up the bounding box
+    mutex merge;
+    births = deaths = 0;
+    hasLife = false;
+    const int offset = regionTop, firstColumn = regionLeft + 1, lastColumn = regionRight;
+    parallelFor(regionBottom - regionTop, [&](const int& begin, const int& end) {
+        uint64_t born = 0, died = 0;
+        int bandTop = -1, bandBottom = 0, bandLeft = columns, bandRight = 0;
+        for (int i = offset + begin + 1; i <= offset + end; ++i)
+        {
+            Cell* line = cells[i].data();
+            int first = -1, last = 0;
+            for (int j = firstColumn; j <= lastColumn; ++j)
+            {
+                Cell& c = line[j];
+                const bool was = c.getState() == STATE_ALIVE, is = c.getNextState() == STATE_ALIVE;
+                c.setState(c.getNextState());
+                // without branches, the states are hard to predict
+                born += is & !was;
+                died += was & !is;
+                first = first < 0 && is ? j : first;
+                last = is ? j : last;
+            }
+            if (first < 0) continue;
+            if (bandTop < 0) bandTop = i;
+            bandBottom = i + 1;
+            bandLeft = min(bandLeft, first);
+            bandRight = max(bandRight, last + 1);
+        }
+
+        lock_guard<mutex> lock(merge);
+        births += born;
+        deaths += died;
+        if (bandTop < 0) return;
+        // from the indexes of cells to 0-based locations
+        if (!hasLife)
+        {
+            top = bandTop - 1;
+            bottom = bandBottom - 1;
+            left = bandLeft - 1;
+            right = bandRight - 1;
+            hasLife = true;
+        }
+        else
+        {
+            top = min(top, bandTop - 1);
+            bottom = max(bottom, bandBottom - 1);
+            left = min(left, bandLeft - 1);
+            right = max(right, bandRight - 1);
+        }
+    });
+    population += births - deaths;
+}
+
+void CellEngine::measure()
+{
+    population = 0;
+    hasLife = false;
+    for (int i = 1; i <= getLines(); ++i)
+        for (int j = 1; j <= getColumns(); ++j)
+        {
+            if (cells[i][j].getState() != STATE_ALIVE) continue;
+            ++population;
+            expand(i - 1, j - 1);
+        }
+}
+
+void CellEngine::expand(const int& line, const int& column)
+{
+    if (!hasLife)
+    {
+        top = line;
+        left = column;
+        bottom = line + 1;
+        right = column + 1;
+        hasLife = true;
+        return;
+    }
+    top = min(top, line);
+    left = min(left, column);
+    bottom = max(bottom, line + 1);
+    right = max(right, column + 1);
+}
+
+void CellEngine::wrapBorder()
+{
+    // the lines first, then the columns including the corners of the ring
+    for (int j = 1; j <= getColumns(); ++j)
+    {
+        cells[0][j].setState(cells[getLines()][j].getState());
+        cells[lines - 1][j].setState(cells[1][j].getState());
+    }
+    for (int i = 0; i != lines; ++i)
+    {
+        cells[i][0].setState(cells[i][getColumns()].getState());
+        cells[i][columns - 1].setState(cells[i][1].getState());
+    }
+}
+
+void CellEngine::resetBorder()
+{
+    for (int j = 0; j != columns; ++j)
+    {
+        cells[0][j].setState(STATE_BORDER);
+        cells[lines - 1][j].setState(STATE_BORDER);
+    }
+    for (int i = 0; i != lines; ++i)
+    {
+        cells[i][0].setState(STATE_BORDER);
+        cells[i][columns - 1].setState(STATE_BORDER);
+    }
+}
+
+void CellEngine::store(BitBoard& board) const
+{
+    if (board.getLines() != getLines() || board.getColumns() != getColumns())
+        board = BitBoard(getLines(), getColumns());
+    for (int i = 1; i <= getLines(); ++i)
+        for (int j = 1; j <= getColumns(); ++j)
+            board.set(i - 1, j - 1, cells[i][j].getState() == STATE_ALIVE);
+}
+
+void CellEngine::load(const BitBoard& board)
+{
+    for (int i = 1; i <= getLines(); ++i)
+        for (int j = 1; j <= getColumns(); ++j)
+            cells[i][j].setState(board.get(i - 1, j - 1) ? STATE_ALIVE : STATE_DEAD);
+    measure();
+}
+
+uint64_t CellEngine::getPopulation() const
+{
+    return population;
+}
+
+bool CellEngine::getBoundingBox(int& boxTop, int& boxLeft, int& boxBottom, int& boxRight) const
+{
+    if (!hasLife) return false;
+    boxTop = top;
+    boxLeft = left;
+    boxBottom = bottom;
+    boxRight = right;
+    return true;
+}
@@ -0,0 +1,89 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_CELLENGINE_H
+#define GOL_CELLENGINE_H
+
+#include <vector>
+#include "Engine.h"
+#include "Cell.h"
+
+/**
+ * The original engine. Every cell is a Cell object, and the board is
+ * surrounded by a ring of border cells.
+ * <br>
+ * With the transparent border, the ring holds copies (ghost cells) of the
+ * opposite edges, refreshed before each generation, so the neighbours of
+ * every cell are found the same way on both kinds of board.
+ * <br>
+ * The population and the bounding box of the live cells are updated while
+ * applying the next states, and only the bounding box and a margin of 1 cell
+ * are stepped, unless the border wraps or the rule has B0.
+ */
+class CellEngine : public Engine
+{
+private:
+    bool flNoBorder = false;
+    int lines = 0, columns = 0; // including the border
+    std::vector<std::vector<Cell>> cells; // the cell board
+    uint64_t population = 0;
+    bool hasLife = false;
+    int top = 0, left = 0, bottom = 0, right = 0; // the bounding box of the live cells, bottom and right excluded
+    int regionTop = 0, regionLeft = 0, regionBottom = 0, regionRight = 0; // the area being stepped, likewise
+
+    /**
+     * Let each cell calculate and set its next state.
+     */
+    void calculateNextGeneration();
+
+    /**
+     * Let each cell apply its next state.
+     */
+    void applyNextGeneration();
+
+    /**
+     * Counts the live cells and finds their bounding box.
+     */
+    void measure();
+
+    /**
+     * Grows the bounding box to a live cell.
+     */
+    void expand(const int& line, const int& column);
+
+    /**
+     * Copies the opposite edges of the board into the border ring.
+     */
+    void wrapBorder();
+
+    /**
+     * Turns the ring back into border cells.
+     */
+    void resetBorder();
+
+public:
+    void init(const int& initLines, const int& initColumns) override;
+
+    int getLines() const override;
+
+    int getColumns() const override;
+
+    CellState getStateOf(const int& line, const int& column) const override;
+
+    void setStateOf(const int& line, const int& column, const CellState& state) override;
+
+    void setNoBorder(const bool& status) override;
+
+    void step() override;
+
+    void store(BitBoard& board) const override;
+
+    void load(const BitBoard& board) override;
+
+    uint64_t getPopulation() const override;
+
+    bool getBoundingBox(int& boxTop, int& boxLeft, int& boxBottom, int& boxRight) const override;
+};
+
+#endif //GOL_CELLENGINE_H
@@ -0,0 +1,358 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include "Census.h"
+#include "BatchRunner.h"
+#include "GoL.h"
+
+using namespace std;
+
+namespace
+{
+    /**
+     * Common objects of B3/S23 in one of their phases, lines separated by '/'.
+     */
+    const char* const KNOWN_OBJECTS[][2] = {
+            {"block",                  "OO/OO"},
+            {"beehive",                ".OO./O..O/.OO."},
+            {"loaf",                   ".OO./O..O/.O.O/..O."},
+            {"boat",                   "OO./O.O/.O."},
+            {"ship",                   "OO./O.O/.OO"},
+            {"tub",                    ".O./O.O/.O."},
+            {"pond",                   ".OO./O..O/O..O/.OO."},
+            {"long boat",              "OO../O.O./.O.O/..O."},
+            {"barge",                  ".O../O.O./.O.O/..O."},
+            {"mango",                  ".OO../O..O./.O..O/..OO."},
+            {"aircraft carrier",       "OO../O..O/..OO"},
+            {"eater 1",                "OO../O.O./..O./..OO"},
+            {"blinker",                "OOO"},
+            {"toad",                   ".OOO/OOO."},
+            {"beacon",                 "OO../O.../...O/..OO"},
+            {"pentadecathlon",         "..O....O../OO.OOOO.OO/..O....O.."},
+            {"glider",                 ".O./..O/OOO"},
+            {"lightweight spaceship",  ".O..O/O..../O...O/OOOO."}
+    };
+
+    const char* const KIND_NAMES[] = {"still life", "oscillator", "spaceship", "unknown"};
+    const char* const KIND_PREFIXES[] = {"xs", "xp", "xq", "xx"};
+
+    BitBoard parseObject(const string& text)
+    {
+        vector<string> rows;
+        stringstream in(text);
+        for (string row; getline(in, row, '/');)
+            rows.push_back(row);
+        BitBoard board((int) rows.size(), (int) rows[0].size());
+        for (int i = 0; i != (int) rows.size(); ++i)
+            for (int j = 0; j != (int) rows[i].size(); ++j)
+                board.set(i, j, rows[i][j] == 'O');
+        return board;
+    }
+}
+
+const int Census::MAX_PERIOD;
+const int Census::STABLE_WINDOW;
+
+Census::Census()
+{
+    setRule(Rule());
+}
+
+Census& Census::setRule(const Rule& newRule)
+{
+    if (newRule.hasBirthOnZero()) throw runtime_error("A census does not support B0 rules");
+    lock_guard<mutex> lock(countMutex);
+    rule = newRule;
+    shapes.clear();
+    names.clear();
+    if (rule.isConway())
+        for (const auto& known : KNOWN_OBJECTS)
+            names[simulate(parseObject(known[1])).id] = known[0];
+    return *this;
+}
+
+Census& Census::setThreads(const int& count)
+{
+    if (count < 1) throw runtime_error("Thread number must be >= 1");
+    threads = count;
+    return *this;
+}
+
+Census& Census::setMaxGenerations(const int& generations)
+{
+    maxGenerations = generations;
+    return *this;
+}
+
+uint64_t Census::hashShape(const BitBoard& shape)
+{
+    // the size is hashed as a word above the first line
+    return shape.hash() ^ BitBoard::hashWord(-1, 0, (uint64_t) shape.getLines() << 32 | (uint32_t) shape.getColumns());
+}
+
+vector<Census::Classification> Census::classify(const BitBoard& shape)
+{
+    const uint64_t key = hashShape(shape);
+    {
+        lock_guard<mutex> lock(countMutex);
+        auto it = shapes.find(key);
+        if (it != shapes.end()) return it->second;
+    }
+    // two threads may classify the same new shape at once, they agree
+    vector<Classification> result;
+    for (const BitBoard& part : separate(shape))
+        result.push_back(simulate(part));
+    lock_guard<mutex> lock(countMutex);
+    shapes.emplace(key, result);
+    return result;
+}
+
+vector<BitBoard> Census::separate(const BitBoard& shape) const
+{
+    vector<BitBoard> parts = split(shape, 1);
+    if (parts.size() == 1) return parts;
+
+    GoL whole;
+    whole.setVerbose(false).setEngine(ENGINE_SPARSE).setThreads(1).setHistoryLimit(0).setRule(rule);
+    whole.init(shape);
+    vector<GoL> alone(parts.size());
+    for (size_t i = 0; i != parts.size(); ++i)
+    {
+        alone[i].setVerbose(false).setEngine(ENGINE_SPARSE).setThreads(1).setHistoryLimit(0).setRule(rule);
+        alone[i].init(parts[i]);
+    }
+    BitBoard current, together, part;
+    for (int g = 0; g != MAX_PERIOD; ++g)
+    {
+        whole.run();
+        whole.store(current);
+        together = BitBoard(current.getLines(), current.getColumns());
+        for (GoL& app : alone)
+        {
+            app.run();
+            if (app.getPopulation() == 0) continue;
+            app.store(part);
+            const int top = part.getOriginLine() - current.getOriginLine();
+            const int left = part.getOriginColumn() - current.getOriginColumn();
+            if (top < 0 || left < 0 || top + part.getLines() > current.getLines()
+                || left + part.getColumns() > current.getColumns())
+                return {shape};
+            for (int i = 0; i != part.getLines(); ++i)
+                for (int j = 0; j != part.getColumns(); ++j)
+                    if (part.get(i, j)) together.set(top + i, left + j, true);
+        }
+        if (together.getWords() != current.getWords()) return {shape};
+    }
+    return parts;
+}
+
+Census::Classification Census::simulate(const BitBoard& shape) const
+{
+    BitBoard start = shape;
+    start.setOrigin(0, 0);
+    GoL app;
+    app.setVerbose(false).setEngine(ENGINE_SPARSE).setThreads(1).setHistoryLimit(0).setRule(rule);
+    app.init(start);
+
+    Classification result{0, OBJECT_UNKNOWN, 0, shape.population()};
+    vector<BitBoard> phases{start};
+    BitBoard current;
+    for (int p = 1; p <= MAX_PERIOD && app.getPopulation() != 0; ++p)
+    {
+        app.run();
+        app.store(current);
+        if (current.getLines() == start.getLines() && current.getColumns() == start.getColumns()
+            && current.getWords() == start.getWords())
+        {
+            const bool moved = current.getOriginLine() != 0 || current.getOriginColumn() != 0;
+            result.kind = moved ? OBJECT_SPACESHIP : p == 1 ? OBJECT_STILL_LIFE : OBJECT_OSCILLATOR;
+            result.period = p;
+            break;
+        }
+        phases.push_back(current);
+    }
+    if (result.kind == OBJECT_UNKNOWN) phases.resize(1); // only the shape as found is this object
+
+    result.id = ~0ULL;
+    for (const BitBoard& phase : phases)
+        for (int s = 0; s != 8; ++s)
+            result.id = min(result.id, hashShape(phase.transformed(s)));
+    return result;
+}
+
+bool Census::settle(const uint64_t& seed, BitBoard& ash) const
+{
+    GoL app;
+    app.setVerbose(false).setEngine(ENGINE_SPARSE).setThreads(1).setHistoryLimit(0).setRule(rule);
+    app.init(BatchRunner::soup(seed, BatchRunner::SOUP_SIZE, BatchRunner::SOUP_SIZE));
+
+    // the population of ash (gliders included) repeats, look for a period every MAX_PERIOD generations
+    vector<uint64_t> populations{app.getPopulation()};
+    for (int g = 1; g <= maxGenerations && populations.back() != 0; ++g)
+    {
+        app.run();
+        populations.push_back(app.getPopulation());
+        const size_t n = populations.size();
+        if (g % MAX_PERIOD != 0 || n < STABLE_WINDOW + MAX_PERIOD) continue;
+        for (int p = 1; p <= MAX_PERIOD; ++p)
+        {
+            size_t k = n - STABLE_WINDOW;
+            while (k != n && populations[k] == populations[k - p])
+                ++k;
+            if (k == n)
+            {
+                app.store(ash);
+                return true;
+            }
+        }
+    }
+    app.store(ash);
+    return populations.back() == 0;
+}
+
+vector<BitBoard> Census::split(const BitBoard& cells, const int& distance)
+{
+    vector<BitBoard> result;
+    BitBoard seen(cells.getLines(), cells.getColumns());
+    vector<pair<int, int>> group;
+    for (int i = 0; i != cells.getLines(); ++i)
+        for (int w = 0; w != cells.getWordsPerLine(); ++w)
+            for (uint64_t bits = cells.line(i)[w] & ~seen.line(i)[w]; bits; bits &= bits - 1)
+            {
+                const int j = w * 64 + __builtin_ctzll(bits);
+                if (seen.get(i, j)) continue; // taken by a group found since the word was read
+                int top = i, left = j, bottom = i + 1, right = j + 1;
+                group.assign(1, {i, j});
+                seen.set(i, j, true);
+                for (size_t c = 0; c != group.size(); ++c)
+                {
+                    const int y = group[c].first, x = group[c].second;
+                    top = min(top, y);
+                    left = min(left, x);
+                    bottom = max(bottom, y + 1);
+                    right = max(right, x + 1);
+                    for (int ny = max(y - distance, 0); ny <= min(y + distance, cells.getLines() - 1); ++ny)
+                        for (int nx = max(x - distance, 0); nx <= min(x + distance, cells.getColumns() - 1); ++nx)
+                            if (cells.get(ny, nx) && !seen.get(ny, nx))
+                            {
+                                seen.set(ny, nx, true);
+                                group.emplace_back(ny, nx);
+                            }
+                }
+                BitBoard object(bottom - top, right - left);
+                object.setOrigin(cells.getOriginLine() + top, cells.getOriginColumn() + left);
+                for (const auto& cell : group)
+                    object.set(cell.first - top, cell.second - left, true);
+                result.push_back(std::move(object));
+            }
+    return result;
+}
+
+void Census::run(const uint64_t& firstSeed, const int& count, const function<void()>& progress)
+{
+    mutex failureMutex;
+    exception_ptr failure;
+    ThreadPool pool(threads);
+    pool.parallelFor(count, [&](const int& begin, const int& end) {
+        BitBoard ash;
+        vector<Classification> found;
+        for (int i = begin; i != end; ++i)
+            try
+            {
+                found.clear();
+                const bool stable = settle(firstSeed + i, ash);
+                // the cells within 2 of each other, so that the phases of e.g. a beacon stay together
+                if (stable)
+                    for (const BitBoard& shape : split(ash, 2))
+                        for (const Classification& c : classify(shape))
+                            found.push_back(c);
+                {
+                    lock_guard<mutex> lock(countMutex);
+                    ++soups;
+                    if (!stable) ++unstabilized;
+                    for (const Classification& c : found)
+                    {
+                        CensusObject& object = objects[c.id];
+                        if (object.count++ != 0) continue;
+                        object.kind = c.kind;
+                        object.period = c.period;
+                        object.population = c.population;
+                        auto name = names.find(c.id);
+                        if (name != names.end()) object.name = name->second;
+                        stringstream code;
+                        code << KIND_PREFIXES[object.kind]
+                             << (object.kind == OBJECT_STILL_LIFE || object.kind == OBJECT_UNKNOWN
+                                 ? (int) object.population : object.period)
+                             << '_' << hex << setw(16) << setfill('0') << c.id;
+                        object.code = code.str();
+                    }
+                }
+                if (progress) progress();
+            }
+            catch (...)
+            {
+                lock_guard<mutex> lock(failureMutex);
+                if (!failure) failure = current_exception();
+            }
+    });
+    if (failure) rethrow_exception(failure);
+}
+
+uint64_t Census::getSoups() const
+{
+    lock_guard<mutex> lock(countMutex);
+    return soups;
+}
+
+uint64_t Census::getUnstabilized() const
+{
+    lock_guard<mutex> lock(countMutex);
+    return unstabilized;
+}
+
+vector<CensusObject> Census::getObjects() const
+{
+    vector<CensusObject> result;
+    {
+        lock_guard<mutex> lock(countMutex);
+        for (const auto& kv : objects)
+            result.push_back(kv.second);
+    }
+    stable_sort(result.begin(), result.end(), [](const CensusObject& a, const CensusObject& b) {
+        return a.count > b.count;
+    });
+    return result;
+}
+
+void Census::write(const string& path) const
+{
+    uint64_t soupCount, unstabilizedCount;
+    {
+        lock_guard<mutex> lock(countMutex);
+        soupCount = soups;
+        unstabilizedCount = unstabilized;
+    }
+    const vector<CensusObject> list = getObjects();
+    const string temp = path + ".tmp";
+    ofstream out(temp, ios::trunc);
+    out << "# soups=" << soupCount << " unstabilized=" << unstabilizedCount << " rule=" << rule.toString() << '\n'
+        << "code,name,kind,period,population,count\n";
+    for (const CensusObject& object : list)
+        out << object.code << ',' << object.name << ',' << KIND_NAMES[object.kind] << ',' << object.period << ','
+            << object.population << ',' << object.count << '\n';
+    out.close();
+    if (out.fail()) throw runtime_error(string("Unable to write census file: ").append(temp));
+#ifdef _WIN32
+    remove(path.c_str()); // rename does not replace files on Windows
+#endif
+    if (rename(temp.c_str(), path.c_str()) != 0)
+        throw runtime_error(string("Unable to write census file: ").append(path));
+}
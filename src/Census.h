@@ -0,0 +1,167 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_CENSUS_H
+#define GOL_CENSUS_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "BitBoard.h"
+#include "Rule.h"
+
+/**
+ * What kind of object a component of the ash is.
+ */
+enum ObjectKind
+{
+    OBJECT_STILL_LIFE = 0,
+    OBJECT_OSCILLATOR = 1,
+    OBJECT_SPACESHIP = 2,
+    OBJECT_UNKNOWN = 3 // not periodic within Census::MAX_PERIOD when alone, e.g. objects which hold each other up
+};
+
+/**
+ * An object found by a census and how many times it was found.
+ */
+struct CensusObject
+{
+    std::string code; // e.g. "xs4_..." for a still life of 4 cells, "xp2_..." for a period 2 oscillator
+    std::string name; // the common name if known, otherwise empty
+    ObjectKind kind = OBJECT_UNKNOWN;
+    int period = 0; // 0 if unknown
+    uint64_t population = 0; // of the phase found first
+    uint64_t count = 0;
+};
+
+/**
+ * Catalogues what random soups settle into. Each soup is simulated on an
+ * infinite plane until its population becomes periodic, then the ash is split
+ * into objects (the cells within 2 of each other) and each object is classified
+ * by simulating it alone: still lifes, oscillators and spaceships with their period.
+ * <br>
+ * An object is identified by a canonical hash, the smallest hash of its phases
+ * in the 8 orientations, so the same object is counted once whatever its phase,
+ * orientation and position. The shapes already classified are memoized and shared
+ * across the threads, the ash of most soups is made of a few common objects only.
+ */
+class Census
+{
+private:
+    struct Classification
+    {
+        uint64_t id; // the canonical hash
+        ObjectKind kind;
+        int period;
+        uint64_t population; // of the phase found
+    };
+
+    Rule rule;
+    int threads = 1;
+    int maxGenerations = 50000;
+    mutable std::mutex countMutex;
+    std::unordered_map<uint64_t, std::vector<Classification>> shapes; // by the hash of a shape as found, guarded by countMutex
+    std::unordered_map<uint64_t, std::string> names; // the common names by canonical hash
+    std::map<uint64_t, CensusObject> objects; // guarded by countMutex
+    uint64_t soups = 0, unstabilized = 0; // guarded by countMutex
+
+    /**
+     * Hashes a shape cropped to its live cells, including its size.
+     */
+    static uint64_t hashShape(const BitBoard& shape);
+
+    /**
+     * Classifies the objects of a shape cropped to its live cells, from the memo if the shape was seen before.
+     */
+    std::vector<Classification> classify(const BitBoard& shape);
+
+    /**
+     * Splits a shape into its 8-connected parts if they do not interact, i.e. they evolve
+     * the same alone as together for MAX_PERIOD generations (e.g. the 4 blinkers of a
+     * traffic light, but not the 2 halves of a beacon).
+     */
+    std::vector<BitBoard> separate(const BitBoard& shape) const;
+
+    /**
+     * Simulates an object alone to find its period, and its canonical hash.
+     */
+    Classification simulate(const BitBoard& shape) const;
+
+    /**
+     * Simulates a soup until its population becomes periodic.
+     * @param ash Set to the cells left.
+     * @return false if it did not within the generation limit.
+     */
+    bool settle(const uint64_t& seed, BitBoard& ash) const;
+
+    /**
+     * Splits cells into groups cropped to their live cells, the cells within a distance of each other.
+     */
+    static std::vector<BitBoard> split(const BitBoard& cells, const int& distance);
+
+public:
+    /**
+     * The longest period looked for, both of the population of a soup and of an object.
+     */
+    static const int MAX_PERIOD = 60;
+
+    /**
+     * For how many generations the population of a soup must repeat to be taken as periodic.
+     */
+    static const int STABLE_WINDOW = 4 * MAX_PERIOD;
+
+    Census();
+
+    /**
+     * Sets the rule, the common names of the objects are only known for B3/S23.
+     * @throws std::runtime_error if the rule is B0 (a soup would fill the plane).
+     */
+    Census& setRule(const Rule& newRule);
+
+    /**
+     * Sets how many soups are simulated at once.
+     */
+    Census& setThreads(const int& count);
+
+    /**
+     * Sets after how many generations a soup which is not periodic yet is given up.
+     */
+    Census& setMaxGenerations(const int& generations);
+
+    /**
+     * Simulates soups and adds what they settle into to the counts.
+     * @param firstSeed The seed of the first soup, the seeds of the others follow (see BatchRunner::soup()).
+     * @param count The number of soups.
+     * @param progress Called after each soup on the simulating thread, may be empty.
+     */
+    void run(const uint64_t& firstSeed, const int& count, const std::function<void()>& progress);
+
+    /**
+     * How many soups have been simulated.
+     */
+    uint64_t getSoups() const;
+
+    /**
+     * How many soups were given up, their ash is not counted.
+     */
+    uint64_t getUnstabilized() const;
+
+    /**
+     * Gets the objects found so far, the most common first.
+     */
+    std::vector<CensusObject> getObjects() const;
+
+    /**
+     * Writes the counts to a CSV file. The file is replaced at once, so it can
+     * be read while the census is running.
+     * @throws std::runtime_error if the file can not be written.
+     */
+    void write(const std::string& path) const;
+};
+
+#endif //GOL_CENSUS_H
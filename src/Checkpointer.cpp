@@ -0,0 +1,225 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <stdexcept>
+#include "Checkpointer.h"
+#include "BoardFile.h"
+
+#ifdef _WIN32
+
+#include <windows.h>
+#include <direct.h>
+
+#else
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+using namespace std;
+
+namespace
+{
+    const string PREFIX = "checkpoint-", SUFFIX = ".golb";
+
+#ifndef _WIN32
+
+    /**
+     * Makes sure the content of a file or a directory is on the disk.
+     */
+    void sync(const string& path)
+    {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        fsync(fd);
+        close(fd);
+    }
+
+#endif
+}
+
+const size_t Checkpointer::KEEP;
+
+Checkpointer::Checkpointer(const string& directory, const int& every) : directory(directory), every(every), busy(false)
+{
+    if (every < 1) throw runtime_error("Checkpoint interval must be >= 1");
+#ifdef _WIN32
+    if (_mkdir(directory.c_str()) != 0 && errno != EEXIST)
+#else
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+#endif
+        throw runtime_error(string("Unable to create checkpoint directory: ").append(directory));
+    kept = list(directory);
+    writer = thread(&Checkpointer::work, this);
+}
+
+Checkpointer::~Checkpointer()
+{
+    {
+        lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    ready.notify_one();
+    writer.join();
+}
+
+vector<long> Checkpointer::list(const string& directory)
+{
+    vector<string> names;
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((directory + "\\*").c_str(), &data);
+    if (find != INVALID_HANDLE_VALUE)
+    {
+        do
+            names.emplace_back(data.cFileName);
+        while (FindNextFileA(find, &data));
+        FindClose(find);
+    }
+#else
+    DIR* dir = opendir(directory.c_str());
+    if (dir)
+    {
+        while (const dirent* entry = readdir(dir))
+            names.emplace_back(entry->d_name);
+        closedir(dir);
+    }
+#endif
+
+    vector<long> generations;
+    for (const string& name : names)
+    {
+        if (name.size() <= PREFIX.size() + SUFFIX.size() || name.compare(0, PREFIX.size(), PREFIX) != 0
+            || name.compare(name.size() - SUFFIX.size(), SUFFIX.size(), SUFFIX) != 0)
+            continue;
+        const string digits = name.substr(PREFIX.size(), name.size() - PREFIX.size() - SUFFIX.size());
+        if (digits.find_first_not_of("0123456789") != string::npos) continue;
+        try
+        {
+            generations.push_back(stol(digits));
+        }
+        catch (out_of_range&)
+        {
+            // not one of ours, the generations fit in an int
+        }
+    }
+    sort(generations.begin(), generations.end());
+    return generations;
+}
+
+string Checkpointer::pathOf(const string& directory, const long& generation)
+{
+    return directory + "/" + PREFIX + to_string(generation) + SUFFIX;
+}
+
+void Checkpointer::work()
+{
+    unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        ready.wait(lock, [this] { return closing || busy; });
+        if (!busy) return; // closing
+        lock.unlock();
+
+        const string path = pathOf(directory, snapshotGeneration), temp = path + ".tmp";
+        string failure;
+        if (!BoardFile::write(temp, snapshot, snapshotGeneration, snapshotRule))
+            failure = string("Unable to write checkpoint: ").append(temp);
+        else
+        {
+#ifdef _WIN32
+            remove(path.c_str()); // rename does not replace files on Windows
+#else
+            sync(temp); // the content must reach the disk before the name does
+#endif
+            if (rename(temp.c_str(), path.c_str()) != 0)
+                failure = string("Unable to rename checkpoint: ").append(temp);
+#ifndef _WIN32
+            else
+                sync(directory);
+#endif
+        }
+        if (!failure.empty()) remove(temp.c_str());
+
+        lock.lock();
+        error = failure;
+        if (failure.empty())
+        {
+            // the checkpoints after this one are from a timeline which was reverted
+            while (!kept.empty() && kept.back() >= snapshotGeneration)
+            {
+                if (kept.back() != snapshotGeneration) remove(pathOf(directory, kept.back()).c_str());
+                kept.pop_back();
+            }
+            kept.push_back(snapshotGeneration);
+            while (kept.size() > KEEP)
+            {
+                remove(pathOf(directory, kept.front()).c_str());
+                kept.erase(kept.begin());
+            }
+        }
+        busy = false;
+    }
+}
+
+bool Checkpointer::isDue(const int& generation)
+{
+    if (lastGeneration < 0 || generation < lastGeneration)
+    {
+        lastGeneration = generation;
+        return false;
+    }
+    return generation - lastGeneration >= every && !busy;
+}
+
+BitBoard& Checkpointer::getSnapshot()
+{
+    return snapshot;
+}
+
+void Checkpointer::commit(const int& generation, const Rule& rule)
+{
+    lastGeneration = generation;
+    {
+        lock_guard<std::mutex> lock(mutex);
+        snapshotGeneration = generation;
+        snapshotRule = rule;
+        busy = true;
+    }
+    ready.notify_one();
+}
+
+string Checkpointer::getError()
+{
+    lock_guard<std::mutex> lock(mutex);
+    return error;
+}
+
+string Checkpointer::findLatest(const string& directory)
+{
+    vector<long> generations = list(directory);
+    for (size_t i = generations.size(); i-- != 0;)
+    {
+        const string path = pathOf(directory, generations[i]);
+        try
+        {
+            BitBoard board;
+            long generation;
+            Rule rule;
+            BoardFile::read(path, board, generation, rule);
+            return path;
+        }
+        catch (exception&)
+        {
+            // damaged, try the one before
+        }
+    }
+    throw runtime_error(string("No valid checkpoint in: ").append(directory));
+}
@@ -0,0 +1,110 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_CHECKPOINTER_H
+#define GOL_CHECKPOINTER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BitBoard.h"
+#include "Rule.h"
+
+/**
+ * Saves checkpoints of a running board into a directory, as binary board
+ * files (.golb) named "checkpoint-{generation}.golb".
+ * <br>
+ * The caller copies the board into a snapshot and goes on, the snapshot is
+ * written on a background thread. A checkpoint is written to a temporary
+ * file which is renamed once complete, so a crash never leaves a partial
+ * checkpoint behind. A checkpoint falling due while the last one is still
+ * being written waits for the next generation. Only the latest KEEP
+ * checkpoints are kept.
+ */
+class Checkpointer
+{
+private:
+    std::string directory;
+    int every;
+    int lastGeneration = -1; // of the last checkpoint, -1 before the first generation is seen
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::atomic<bool> busy; // set while the snapshot is being written
+    bool closing = false;
+    BitBoard snapshot;
+    long snapshotGeneration = 0;
+    Rule snapshotRule;
+    std::vector<long> kept; // the generations of the checkpoints in the directory, the oldest first
+    std::string error; // of the last failed checkpoint
+
+    /**
+     * The main loop of the writer thread.
+     */
+    void work();
+
+    /**
+     * Lists the generations of the checkpoints in a directory, the oldest first.
+     * Names with a number too large for a long are skipped.
+     */
+    static std::vector<long> list(const std::string& directory);
+
+    static std::string pathOf(const std::string& directory, const long& generation);
+
+public:
+    /**
+     * How many checkpoints are kept in the directory.
+     */
+    static const size_t KEEP = 2;
+
+    /**
+     * Starts the writer thread, creating the directory if it does not exist.
+     * @param every Generations between the checkpoints.
+     * @throws std::runtime_error if the directory can not be created.
+     */
+    Checkpointer(const std::string& directory, const int& every);
+
+    Checkpointer(const Checkpointer&) = delete;
+
+    Checkpointer& operator =(const Checkpointer&) = delete;
+
+    /**
+     * Waits for the checkpoint being written.
+     */
+    ~Checkpointer();
+
+    /**
+     * Is a checkpoint due at a generation, and can it be taken now? The first generation
+     * seen, and any generation before the last checkpoint (e.g. after reverting), start
+     * the count again.
+     */
+    bool isDue(const int& generation);
+
+    /**
+     * Gets the snapshot to copy the board into, only when isDue().
+     */
+    BitBoard& getSnapshot();
+
+    /**
+     * Writes the snapshot in the background.
+     */
+    void commit(const int& generation, const Rule& rule);
+
+    /**
+     * Gets why the last checkpoint failed, empty if it did not.
+     */
+    std::string getError();
+
+    /**
+     * Finds the latest checkpoint in a directory which is complete and passes its checksum.
+     * @return The path of the checkpoint.
+     * @throws std::runtime_error if there is none.
+     */
+    static std::string findLatest(const std::string& directory);
+};
+
+#endif //GOL_CHECKPOINTER_H
@@ -22,6 +22,26 @@ CellState CommonUtil::parseCellState(const char& c)
            STATE_BORDER;
 }
 
+const char* CommonUtil::toString(const CellState& state)
+{
+#ifdef _WIN32
+    return state == STATE_BORDER ? "##" :
+           state == STATE_DEAD ? ". "
+                               : "[]";
+#else
+    return state == STATE_BORDER ? "囗" :
+           state == STATE_DEAD ? "丶"
+                               : "回";
+#endif
+}
+
+char CommonUtil::toChar(const CellState& state)
+{
+    return state == STATE_BORDER ? '#' :
+           state == STATE_DEAD ? '0' :
+           '1';
+}
+
 void CommonUtil::freeze(const unsigned int& ms)
 {
 #ifdef _WIN32
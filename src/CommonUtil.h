@@ -17,6 +17,19 @@ public:
      */
     static CellState parseCellState(const char& c);
 
+    /**
+     * Converts a CellState to string.
+     * @return Square if alive, dot if dead, a hollow square if border.
+     * The exact look depends on the operating system.
+     */
+    static const char* toString(const CellState& state);
+
+    /**
+     * Converts a CellState to a character.
+     * @return '1' if alive, '0' if dead, '#' if border.
+     */
+    static char toChar(const CellState& state);
+
     /**
      * Freezes the program for a few moment.
      * @param ms The milliseconds of the time to freeze.
@@ -0,0 +1,58 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include "CycleTable.h"
+
+const size_t CycleTable::CAPACITY;
+
+void CycleTable::clear()
+{
+    recent.clear();
+    generations.clear();
+    period = cycleStart = 0;
+}
+
+void CycleTable::record(const int& generation, const uint64_t& hash)
+{
+    if (!recent.empty() && recent.back().first + 1 != generation) clear();
+
+    auto it = generations.find(hash);
+    if (it != generations.end())
+    {
+        // the first repetition found is the start of the cycle, later ones only confirm it
+        if (period == 0)
+        {
+            period = generation - it->second;
+            cycleStart = it->second;
+        }
+        it->second = generation;
+    }
+    else
+        generations.emplace(hash, generation);
+
+    recent.emplace_back(generation, hash);
+    if (recent.size() > CAPACITY)
+    {
+        // forget the oldest generation unless its hash has been seen again since
+        auto oldest = generations.find(recent.front().second);
+        if (oldest != generations.end() && oldest->second == recent.front().first)
+            generations.erase(oldest);
+        recent.pop_front();
+    }
+}
+
+int CycleTable::getLatestGeneration() const
+{
+    return recent.empty() ? -1 : recent.back().first;
+}
+
+int CycleTable::getPeriod() const
+{
+    return period;
+}
+
+int CycleTable::getCycleStart() const
+{
+    return cycleStart;
+}
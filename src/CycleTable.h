@@ -0,0 +1,56 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_CYCLETABLE_H
+#define GOL_CYCLETABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+
+/**
+ * Finds out when the cell board becomes still or periodic, from the hashes
+ * of the recent generations. A generation whose hash was seen P generations
+ * ago starts to repeat with period P (1 for a still life).
+ * <br>
+ * Only the last CAPACITY generations are remembered, so longer periods are
+ * not detected.
+ */
+class CycleTable
+{
+public:
+    static const size_t CAPACITY = 1024;
+
+private:
+    std::deque<std::pair<int, uint64_t>> recent; // (generation, hash), the oldest first
+    std::unordered_map<uint64_t, int> generations; // the latest generation of each hash
+    int period = 0, cycleStart = 0;
+
+public:
+    void clear();
+
+    /**
+     * Records the hash of a generation. Recording a generation which does not follow
+     * the latest recorded one clears the table first.
+     */
+    void record(const int& generation, const uint64_t& hash);
+
+    /**
+     * Gets the latest recorded generation, -1 if the table is empty.
+     */
+    int getLatestGeneration() const;
+
+    /**
+     * Gets the period of the cycle, 0 if no cycle has been found.
+     */
+    int getPeriod() const;
+
+    /**
+     * Gets the first generation of the cycle.
+     */
+    int getCycleStart() const;
+};
+
+#endif //GOL_CYCLETABLE_H
@@ -0,0 +1,251 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_ENGINE_H
+#define GOL_ENGINE_H
+
+#include "CellState.h"
+#include "BitBoard.h"
+#include "Rule.h"
+#include "Stats.h"
+#include "ThreadPool.h"
+
+/**
+ * The available simulation engines.
+ */
+enum EngineType
+{
+    ENGINE_CELL = 0, // one Cell object per cell, neighbours are cached as pointers
+    ENGINE_BITPACKED = 1, // 64 cells per machine word, stepped with bitwise adders
+    ENGINE_HASHLIFE = 2, // memoized quadtree on an infinite plane, advances by powers of 2
+    ENGINE_SPARSE = 3, // hash map of chunks on an infinite plane, allocated where the cells live
+    ENGINE_FIXED = 4 // a word per line of a board size known at compile time, cell engine for the other sizes
+};
+
+/**
+ * The storage and the stepping algorithm of a cell board.
+ * <br>
+ * All locations used by an engine are 0-based and never include the border,
+ * the caller is responsible for bounds checking and coordinate wrapping.
+ * An unbounded engine accepts any location, and its cell board is the area
+ * starting at the origin.
+ */
+class Engine
+{
+protected:
+    ThreadPool* pool = nullptr; // steps the board in parallel if set
+    Rule rule; // B3/S23 unless changed
+    Stats* stats = nullptr; // times the phases inside a step if set
+    uint64_t evaluatedCells = 0; // calculated in the last step
+    uint64_t births = 0, deaths = 0; // in the last step
+
+    /**
+     * Runs body(begin, end) over [0, count), in parallel if a thread pool is set.
+     */
+    void parallelFor(const int& count, const std::function<void(const int&, const int&)>& body)
+    {
+        if (pool)
+            pool->parallelFor(count, body);
+        else
+            body(0, count);
+    }
+
+public:
+    virtual ~Engine() = default;
+
+    /**
+     * Sets the thread pool used to step the board, nullptr to step on the calling thread.
+     */
+    void setThreadPool(ThreadPool* threadPool)
+    {
+        pool = threadPool;
+    }
+
+    /**
+     * Sets the stats the phases inside a step are timed into, nullptr to stop timing them.
+     */
+    void setStats(Stats* newStats)
+    {
+        stats = newStats;
+    }
+
+    /**
+     * Sets the rule used by the following steps.
+     * @throws std::runtime_error if the engine does not support the rule.
+     */
+    virtual void setRule(const Rule& newRule)
+    {
+        rule = newRule;
+    }
+
+    const Rule& getRule() const
+    {
+        return rule;
+    }
+
+    /**
+     * Initialize an empty cell board.
+     * @param lines The lines of the cell board (without border).
+     * @param columns The columns of the cell board (without border).
+     */
+    virtual void init(const int& lines, const int& columns) = 0;
+
+    virtual int getLines() const = 0;
+
+    virtual int getColumns() const = 0;
+
+    /**
+     * Gets the location of the top-left corner of the cell board, always 0 for bounded engines.
+     */
+    virtual int getOriginLine() const
+    {
+        return 0;
+    }
+
+    virtual int getOriginColumn() const
+    {
+        return 0;
+    }
+
+    /**
+     * Does the engine accept locations out of the cell board?
+     */
+    virtual bool isUnbounded() const
+    {
+        return false;
+    }
+
+    virtual CellState getStateOf(const int& line, const int& column) const = 0;
+
+    virtual void setStateOf(const int& line, const int& column, const CellState& state) = 0;
+
+    /**
+     * Turns on/off the transparent border.
+     */
+    virtual void setNoBorder(const bool& status) = 0;
+
+    /**
+     * Calculates and applies the next generation.
+     */
+    virtual void step() = 0;
+
+    /**
+     * Can the engine advance many generations at once much faster than stepping them one by one?
+     */
+    virtual bool canJump() const
+    {
+        return false;
+    }
+
+    /**
+     * Advances a specified amount of generations.
+     */
+    virtual void forward(const int& steps)
+    {
+        for (int i = 0; i < steps; ++i)
+            step();
+    }
+
+    /**
+     * Copies the current state of the cell board into a bit-packed snapshot.
+     */
+    virtual void store(BitBoard& board) const = 0;
+
+    /**
+     * Replaces the current state of the cell board with a snapshot.
+     * The snapshot must have the same size as the cell board.
+     */
+    virtual void load(const BitBoard& board) = 0;
+
+    /**
+     * Copies all the live cells into a bit-packed snapshot, its origin set to the location of
+     * its top-left cell. The same as store() unless the engine keeps cells out of the cell board
+     * (hashlife), then the snapshot covers the cell board and all the live cells out of it.
+     * @param maxBytes The most the snapshot may take.
+     * @return false if it would take more, the snapshot is left unchanged.
+     */
+    virtual bool storeUniverse(BitBoard& board, const size_t& maxBytes) const
+    {
+        store(board);
+        return true;
+    }
+
+    /**
+     * Replaces all the cells with a snapshot taken by storeUniverse().
+     */
+    virtual void loadUniverse(const BitBoard& board)
+    {
+        load(board);
+    }
+
+    /**
+     * Hashes the cell board, see BitBoard::hashWord(). Engines which keep the hash
+     * up to date while stepping return it at once, the others hash a snapshot.
+     */
+    virtual uint64_t getHash() const
+    {
+        BitBoard board;
+        store(board);
+        return board.hash();
+    }
+
+    /**
+     * How many tiles were recalculated in the last step, and how many tiles are there?
+     * Both are 0 if the engine does not skip unchanged tiles.
+     */
+    virtual void getTileStats(long& activeCount, long& total) const
+    {
+        activeCount = total = 0;
+    }
+
+    /**
+     * How many cells were calculated in the last step? 0 for the engines which do
+     * not calculate cell by cell (hashlife).
+     */
+    uint64_t getEvaluatedCells() const
+    {
+        return evaluatedCells;
+    }
+
+    /**
+     * How many cells were born and how many died in the last step? Both are 0 for
+     * the engines which do not calculate cell by cell (hashlife). Engines which only
+     * count them when asked override it.
+     */
+    virtual void getChanges(uint64_t& born, uint64_t& died) const
+    {
+        born = births;
+        died = deaths;
+    }
+
+    /**
+     * Counts the live cells. Engines which keep the count up to date while stepping
+     * return it at once, the others count a snapshot.
+     */
+    virtual uint64_t getPopulation() const
+    {
+        BitBoard board;
+        store(board);
+        return board.population();
+    }
+
+    /**
+     * Finds the bounding box of the live cells, bottom and right excluded. Engines which
+     * keep the box up to date while stepping return it at once, the others scan a snapshot.
+     * @return false if there is no live cell.
+     */
+    virtual bool getBoundingBox(int& top, int& left, int& bottom, int& right) const
+    {
+        BitBoard board;
+        store(board);
+        if (!board.boundingBox(top, left, bottom, right)) return false;
+        top += getOriginLine();
+        bottom += getOriginLine();
+        left += getOriginColumn();
+        right += getOriginColumn();
+        return true;
+    }
+};
+
+#endif //GOL_ENGINE_H
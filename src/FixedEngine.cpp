@@ -0,0 +1,198 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <stdexcept>
+#include "FixedEngine.h"
+#include "Kernel.h"
+
+using namespace std;
+
+template<int Lines, int Columns>
+template<bool Wrap, bool Conway>
+void FixedEngine<Lines, Columns>::advance()
+{
+    // every cell sees its west neighbour in west(), its east neighbour in east()
+    auto west = [](const uint64_t& l) { return l << 1 | (Wrap ? l >> (Columns - 1) : 0); };
+    auto east = [](const uint64_t& l) { return l >> 1 | (Wrap ? (l & 1) << (Columns - 1) : 0); };
+
+    uint64_t changes = 0;
+    uint64_t up = Wrap ? rows[Lines - 1] : 0, mid = rows[0];
+    for (int i = 0; i != Lines; ++i)
+    {
+        const uint64_t down = i != Lines - 1 ? rows[i + 1] : Wrap ? rows[0] : 0;
+        const uint64_t n = Kernel::word<Conway>(west(up), up, east(up), west(mid), mid, east(mid),
+                                                west(down), down, east(down), rule) & mask();
+        previous[i] = n; // swapped below
+        changes |= n ^ mid;
+        up = mid;
+        mid = down;
+    }
+    rows.swap(previous);
+    flStill = changes == 0;
+}
+
+template<int Lines, int Columns>
+void FixedEngine<Lines, Columns>::edit()
+{
+    if (!flCounted) getChanges(births, deaths);
+    flCounted = true;
+    flStill = false;
+}
+
+template<int Lines, int Columns>
+void FixedEngine<Lines, Columns>::init(const int& initLines, const int& initColumns)
+{
+    if (initLines != Lines || initColumns != Columns)
+        throw runtime_error("The board size does not match the fixed-size engine");
+    rows.fill(0);
+    previous.fill(0);
+    births = deaths = 0;
+    flCounted = true;
+    flStill = false;
+}
+
+template<int Lines, int Columns>
+int FixedEngine<Lines, Columns>::getLines() const
+{
+    return Lines;
+}
+
+template<int Lines, int Columns>
+int FixedEngine<Lines, Columns>::getColumns() const
+{
+    return Columns;
+}
+
+template<int Lines, int Columns>
+CellState FixedEngine<Lines, Columns>::getStateOf(const int& line, const int& column) const
+{
+    return (rows[line] >> column) & 1 ? STATE_ALIVE : STATE_DEAD;
+}
+
+template<int Lines, int Columns>
+void FixedEngine<Lines, Columns>::setStateOf(const int& line, const int& column, const CellState& state)
+{
+    edit();
+    if (state == STATE_ALIVE)
+        rows[line] |= 1ULL << column;
+    else
+        rows[line] &= ~(1ULL << column);
+}
+
+template<int Lines, int Columns>
+void FixedEngine<Lines, Columns>::setNoBorder(const bool& status)
+{
+    flNoBorder = status;
+    flStill = false;
+}
+
+template<int Lines, int Columns>
+void FixedEngine<Lines, Columns>::setRule(const Rule& newRule)
+{
+    Engine::setRule(newRule);
+    flStill = false;
+}
+
+template<int Lines, int Columns>
+void FixedEngine<Lines, Columns>::step()
+{
+    flCounted = false;
+    if (flStill)
+    {
+        // the next generation is the same again, previous is already the same as rows
+        evaluatedCells = 0;
+        return;
+    }
+    if (flNoBorder && rule.isConway())
+        advance<true, true>();
+    else if (flNoBorder)
+        advance<true, false>();
+    else if (rule.isConway())
+        advance<false, true>();
+    else
+        advance<false, false>();
+    evaluatedCells = (uint64_t) Lines * Columns;
+}
+
+template<int Lines, int Columns>
+void FixedEngine<Lines, Columns>::store(BitBoard& board) const
+{
+    if (board.getLines() != Lines || board.getColumns() != Columns) board = BitBoard(Lines, Columns);
+    for (int i = 0; i != Lines; ++i)
+        board.line(i)[0] = rows[i];
+}
+
+template<int Lines, int Columns>
+void FixedEngine<Lines, Columns>::load(const BitBoard& board)
+{
+    edit();
+    for (int i = 0; i != Lines; ++i)
+        rows[i] = board.line(i)[0] & mask();
+}
+
+template<int Lines, int Columns>
+uint64_t FixedEngine<Lines, Columns>::getHash() const
+{
+    uint64_t h = 0;
+    for (int i = 0; i != Lines; ++i)
+        h ^= BitBoard::hashWord(i, 0, rows[i]);
+    return h;
+}
+
+template<int Lines, int Columns>
+void FixedEngine<Lines, Columns>::getChanges(uint64_t& born, uint64_t& died) const
+{
+    if (flCounted)
+    {
+        Engine::getChanges(born, died);
+        return;
+    }
+    born = died = 0;
+    for (int i = 0; i != Lines; ++i)
+    {
+        born += __builtin_popcountll(rows[i] & ~previous[i]);
+        died += __builtin_popcountll(previous[i] & ~rows[i]);
+    }
+}
+
+template<int Lines, int Columns>
+uint64_t FixedEngine<Lines, Columns>::getPopulation() const
+{
+    uint64_t n = 0;
+    for (const uint64_t& l : rows)
+        n += __builtin_popcountll(l);
+    return n;
+}
+
+template<int Lines, int Columns>
+bool FixedEngine<Lines, Columns>::getBoundingBox(int& top, int& left, int& bottom, int& right) const
+{
+    uint64_t columns = 0;
+    top = -1;
+    for (int i = 0; i != Lines; ++i)
+    {
+        if (!rows[i]) continue;
+        if (top < 0) top = i;
+        bottom = i + 1;
+        columns |= rows[i];
+    }
+    if (top < 0) return false;
+    left = __builtin_ctzll(columns);
+    right = 64 - __builtin_clzll(columns);
+    return true;
+}
+
+template class FixedEngine<16, 16>;
+
+template class FixedEngine<32, 32>;
+
+template class FixedEngine<64, 64>;
+
+unique_ptr<Engine> createFixedEngine(const int& lines, const int& columns)
+{
+    if (lines == 16 && columns == 16) return unique_ptr<Engine>(new FixedEngine<16, 16>());
+    if (lines == 32 && columns == 32) return unique_ptr<Engine>(new FixedEngine<32, 32>());
+    if (lines == 64 && columns == 64) return unique_ptr<Engine>(new FixedEngine<64, 64>());
+    return nullptr;
+}
@@ -0,0 +1,98 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_FIXEDENGINE_H
+#define GOL_FIXEDENGINE_H
+
+#include <array>
+#include <memory>
+#include "Engine.h"
+
+/**
+ * An engine for one board size known at compile time, at most 64 columns wide.
+ * Each line is a single 64-bit word of a std::array, so the whole board stays
+ * in L1 (512 bytes at 64 * 64), and every loop bound, shift and mask is a
+ * constant the compiler can unroll and fold. The topology (the dead border or
+ * the transparent one) and whether the rule is B3/S23 are template parameters of
+ * the step, chosen once per step.
+ * <br>
+ * Small boards spend most of a step on the bookkeeping of the general engines
+ * (tiles, kernels, regions, counters), so a step here only calculates the lines.
+ * The population and the births and deaths of the last step are counted from
+ * the lines when asked, and a board which did not change is not stepped again.
+ * <br>
+ * The sizes in use are instantiated in FixedEngine.cpp, see createFixedEngine().
+ */
+template<int Lines, int Columns>
+class FixedEngine : public Engine
+{
+    static_assert(Lines >= 2 && Columns >= 2 && Columns <= 64, "A fixed board must be 2*2 to 64 columns wide");
+
+private:
+    bool flNoBorder = false;
+    bool flStill = false; // did the last step change nothing?
+    bool flCounted = true; // have the births and deaths of the last step been counted since the cells were edited?
+    std::array<uint64_t, Lines> rows{}, previous{}; // the current lines and the lines before the last step
+
+    /**
+     * The bits of the columns of a line.
+     */
+    static constexpr uint64_t mask()
+    {
+        return Columns == 64 ? ~0ULL : (1ULL << (Columns % 64)) - 1;
+    }
+
+    /**
+     * Calculates and applies the next generation.
+     * @tparam Wrap Are the opposite sides of the board connected (the transparent border)?
+     * @tparam Conway Is the rule B3/S23?
+     */
+    template<bool Wrap, bool Conway>
+    void advance();
+
+    /**
+     * Keeps the counts of the last step before the cells are edited.
+     */
+    void edit();
+
+public:
+    /**
+     * @throws std::runtime_error if the size is not the one of the engine.
+     */
+    void init(const int& initLines, const int& initColumns) override;
+
+    int getLines() const override;
+
+    int getColumns() const override;
+
+    CellState getStateOf(const int& line, const int& column) const override;
+
+    void setStateOf(const int& line, const int& column, const CellState& state) override;
+
+    void setNoBorder(const bool& status) override;
+
+    void setRule(const Rule& newRule) override;
+
+    void step() override;
+
+    void store(BitBoard& board) const override;
+
+    void load(const BitBoard& board) override;
+
+    uint64_t getHash() const override;
+
+    void getChanges(uint64_t& born, uint64_t& died) const override;
+
+    uint64_t getPopulation() const override;
+
+    bool getBoundingBox(int& top, int& left, int& bottom, int& right) const override;
+};
+
+/**
+ * Creates the fixed-size engine of a board size: 16*16, 32*32 or 64*64.
+ * @return null if there is none for the size.
+ */
+std::unique_ptr<Engine> createFixedEngine(const int& lines, const int& columns);
+
+#endif //GOL_FIXEDENGINE_H
@@ -2,185 +2,441 @@
 // Created by mcumbrella on 23-5-10.
 //
 
+#include <algorithm>
+#include <climits>
+#include <cstdint>
 #include <fstream>
+#include <random>
 #include <sstream>
 #include "GoL.h"
-#include "Cell.h"
+#include "BitEngine.h"
+#include "BoardFile.h"
+#include "CellEngine.h"
+#include "FixedEngine.h"
+#include "HashLifeEngine.h"
+#include "PatternFile.h"
+#include "SlabRunner.h"
+#include "SparseEngine.h"
 #include "CommonUtil.h"
+#include "Kernel.h"
 
 #define t CommonUtil::transparent
 
 using namespace std;
 
-GoL& GoL::getInstance()
+const size_t GoL::MAX_REGION_BYTES;
+
+GoL& GoL::setVerbose(const bool& status)
 {
-    static GoL instance;
-    return instance;
+    flVerbose = status;
+    return *this;
 }
 
-GoL& GoL::init(const int& initLines, const int& initColumns)
+GoL& GoL::setEngine(const EngineType& type)
 {
-    if (initLines < 2 || initColumns < 2) throw runtime_error("Line number and column number must be >= 2");
+    engineType = type;
+    return *this;
+}
+
+EngineType GoL::getEngine() const
+{
+    return engineType;
+}
+
+GoL& GoL::setRule(const Rule& newRule)
+{
+    if (engine) engine->setRule(newRule);
+    rule = newRule;
+    cycles.clear();
+    return *this;
+}
+
+const Rule& GoL::getRule() const
+{
+    return rule;
+}
+
+GoL& GoL::setHashLifeLimit(const size_t& bytes)
+{
+    hashLifeLimit = bytes;
+    return *this;
+}
+
+GoL& GoL::setThreads(const int& threads)
+{
+    if (threads < 1) throw runtime_error("Thread number must be >= 1");
+    pool.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
+    if (engine) engine->setThreadPool(pool.get());
+    return *this;
+}
+
+int GoL::getThreads() const
+{
+    return pool ? pool->getThreads() : 1;
+}
+
+GoL& GoL::setProcesses(const int& count)
+{
+    SlabRunner runner(count); // checks the number
+    processes = runner.getProcesses();
+    return *this;
+}
+
+int GoL::getProcesses() const
+{
+    return processes;
+}
+
+bool GoL::canJump() const
+{
+    return engine->canJump() || (processes > 1 && !engine->isUnbounded());
+}
+
+GoL& GoL::setHistoryLimit(const size_t& bytes)
+{
+    history.setBudget(bytes);
+    return *this;
+}
+
+size_t GoL::getHistoryBytes() const
+{
+    return history.getBytes();
+}
 
-    // add a border with the width of 1 cell
-    lines = initLines + 2;
-    columns = initColumns + 2;
+GoL& GoL::setStats(const bool& status)
+{
+    stats.reset(status ? new Stats() : nullptr);
+    if (engine) engine->setStats(stats.get());
+    return *this;
+}
+
+Stats* GoL::getStats() const
+{
+    return stats.get();
+}
 
-    cout << "Initializing cell board with size " << initColumns << " * " << initLines << endl;
-    cells = vector<vector<Cell>>(lines);
-    for (int i = 0; i != lines; ++i)
-        for (int j = 0; j != columns; ++j)
-            if (i == 0 || i == lines - 1)
-                cells[i].emplace_back(STATE_BORDER);
-            else
-                cells[i].emplace_back(j == 0 || j == columns - 1 ? STATE_BORDER : STATE_DEAD);
+GoL& GoL::init(const int& initLines, const int& initColumns)
+{
+    if (initLines < 2 || initColumns < 2) throw runtime_error("Line number and column number must be >= 2");
 
-    cacheCellNeighbours();
+    if (flVerbose) cout << "Initializing cell board with size " << initColumns << " * " << initLines << endl;
+    unique_ptr<Engine> fixed;
+    if (engineType == ENGINE_FIXED)
+        fixed = createFixedEngine(initLines, initColumns); // null unless the size has an engine of its own
+    const bool isFixed = fixed != nullptr;
+    if (isFixed)
+        engine = std::move(fixed);
+    else if (engineType == ENGINE_BITPACKED)
+        engine.reset(new BitEngine());
+    else if (engineType == ENGINE_HASHLIFE)
+        engine.reset(new HashLifeEngine(hashLifeLimit));
+    else if (engineType == ENGINE_SPARSE)
+        engine.reset(new SparseEngine());
+    else
+        engine.reset(new CellEngine());
+    engine->setThreadPool(pool.get());
+    engine->setStats(stats.get());
+    engine->setRule(rule);
+    engine->setNoBorder(flNoBorder);
+    engine->init(initLines, initColumns);
+    if (flVerbose && isFixed)
+        cout << "Using the fixed-size engine of " << initColumns << " * " << initLines << endl;
+    else if (flVerbose && engineType == ENGINE_BITPACKED)
+        cout << "Using kernel: " << Kernel::getName() << endl;
+    currentGeneration = 0;
+    history.clear();
+    cycles.clear();
 
-    cout << "Cell board initialization completed" << endl;
+    if (flVerbose) cout << "Cell board initialization completed" << endl;
     return *this;
 }
 
 GoL& GoL::init(const string& initFilePath)
 {
-    cout << "Using input file: " << initFilePath << endl;
-    ifstream in(initFilePath);
-    if (!in) throw runtime_error(string("Unable to read input file: ").append(initFilePath));
+    if (flVerbose) cout << "Using input file: " << initFilePath << endl;
+    long generation;
+    read(initFilePath, snapshot, rule, generation);
+    setup(snapshot);
+    currentGeneration = (int) generation; // <= INT_MAX, see BoardFile::read()
+    if (flVerbose) cout << "Initialization completed" << endl;
+    return *this;
+}
+
+void GoL::read(const string& filePath, BitBoard& board, Rule& fileRule, long& generation) const
+{
+    generation = 0;
+    if (BoardFile::isBinary(filePath))
+    {
+        BoardFile::read(filePath, board, generation, fileRule);
+        return;
+    }
+    if (PatternFile::isRle(filePath))
+    {
+        PatternFile::readRle(filePath, board, fileRule);
+        return;
+    }
+    if (PatternFile::isCells(filePath))
+    {
+        PatternFile::readCells(filePath, board);
+        return;
+    }
+
+    ifstream in(filePath);
+    if (!in) throw runtime_error(string("Unable to read input file: ").append(filePath));
 
     // read line numbers and column numbers from input file
     int savedLines = 0, savedColumns = 0;
     in >> savedLines >> savedColumns;
-    // initialize cells
-    init(savedLines, savedColumns);
+    if (savedLines < 1 || savedColumns < 1) throw runtime_error("Line number and column number must be >= 1");
+    // the rule may follow the size
+    in >> ws;
+    if (in.peek() == 'B' || in.peek() == 'b' || in.peek() == 'S' || in.peek() == 's')
+    {
+        string text;
+        in >> text;
+        fileRule = Rule::parse(text);
+    }
 
     // read the pattern from the input file
-    cout << "Loading pattern from input" << endl;
+    if (flVerbose) cout << "Loading pattern from input" << endl;
+    board = BitBoard(savedLines, savedColumns);
     string line;
-    for (int i = 0; i != getLines(); ++i)
+    for (int i = 0; i != savedLines; ++i)
     {
         if (in >> line)
         {
-            if (line.length() != getColumns())
+            if (line.length() != (size_t) savedColumns)
             {
                 stringstream msg;
-                msg << "Line length mismatch: at line " << i + 1 << " expected " << getColumns() << " but got " << line.length();
+                msg << "Line length mismatch: at line " << i + 1 << " expected " << savedColumns << " but got " << line.length();
                 throw runtime_error(msg.str());
             }
-            for (int j = 0; j != getColumns(); ++j)
-                setStateOf(i + 1, j + 1, CommonUtil::parseCellState(line[j]));
+            for (int j = 0; j != savedColumns; ++j)
+                board.set(i, j, CommonUtil::parseCellState(line[j]) == STATE_ALIVE);
         }
         else
         {
             stringstream msg;
-            msg << "Total line number mismatch: expected " << getLines() << " but got " << i;
+            msg << "Total line number mismatch: expected " << savedLines << " but got " << i;
             throw runtime_error(msg.str());
         }
     }
-    cout << "Pattern setup completed" << endl;
-    in.close();
-    cout << "Initialization completed" << endl;
+    if (flVerbose) cout << "Pattern setup completed" << endl;
+}
+
+GoL& GoL::init(const BitBoard& initBoard)
+{
+    snapshot = initBoard;
+    setup(snapshot);
     return *this;
 }
 
+void GoL::setup(BitBoard& board)
+{
+    if (board.getLines() < 2 || board.getColumns() < 2)
+    {
+        BitBoard grown(max(board.getLines(), 2), max(board.getColumns(), 2));
+        for (int i = 0; i != board.getLines(); ++i)
+            std::copy(board.line(i), board.line(i) + board.getWordsPerLine(), grown.line(i));
+        grown.setOrigin(board.getOriginLine(), board.getOriginColumn());
+        board = std::move(grown);
+    }
+    init(board.getLines(), board.getColumns());
+    if (!engine->isUnbounded()) board.setOrigin(0, 0);
+    engine->load(board);
+}
+
 GoL& GoL::save(const string& filePath)
 {
-    ofstream out(filePath);
-    if (out)
+    // the cells of hashlife out of the cell board are saved too
+    if (!engine->storeUniverse(snapshot, SIZE_MAX))
+        throw runtime_error("The universe is too large to be saved");
+    bool written;
+    if (BoardFile::hasBinaryExtension(filePath))
+        written = BoardFile::write(filePath, snapshot, currentGeneration, rule);
+    else if (PatternFile::isRle(filePath))
+        written = PatternFile::writeRle(filePath, snapshot, rule);
+    else if (PatternFile::isCells(filePath))
+        written = PatternFile::writeCells(filePath, snapshot);
+    else
     {
-        out << getLines() << ' ' << getColumns() << endl;
-        for (int i = 1; i <= getLines(); ++i)
+        ofstream out(filePath);
+        if (out)
         {
-            for (int j = 1; j <= getColumns(); ++j)
-                out << cells[i][j].toChar();
+            out << snapshot.getLines() << ' ' << snapshot.getColumns();
+            if (!rule.isConway()) out << ' ' << rule.toString();
             out << endl;
+            for (int i = 0; i != snapshot.getLines(); ++i)
+            {
+                for (int j = 0; j != snapshot.getColumns(); ++j)
+                    out << CommonUtil::toChar(snapshot.get(i, j) ? STATE_ALIVE : STATE_DEAD);
+                out << endl;
+            }
+            out.close();
         }
-        out.close();
+        written = !out.fail();
     }
+    if (!written) throw runtime_error(string("Unable to write file: ").append(filePath));
     return *this;
 }
 
-GoL& GoL::run()
+GoL& GoL::setCheckpoints(const string& directory, const int& every)
 {
-    previousCells.push(vector<vector<Cell>>(cells));
-    calculateNextGeneration();
-    applyNextGeneration();
-    ++currentGeneration;
+    checkpointer.reset(); // finish the last checkpoint first
+    if (every > 0) checkpointer.reset(new Checkpointer(directory, every));
     return *this;
 }
 
-void GoL::calculateNextGeneration()
+string GoL::getCheckpointError() const
+{
+    return checkpointer ? checkpointer->getError() : "";
+}
+
+void GoL::checkpoint()
 {
-    for (int i = 1; i <= getLines(); ++i)
+    if (!checkpointer || !checkpointer->isDue(currentGeneration)) return;
+    GOL_PHASE(stats.get(), PHASE_CHECKPOINT);
+    if (!engine->storeUniverse(checkpointer->getSnapshot(), SIZE_MAX)) return;
+    checkpointer->commit(currentGeneration, rule);
+}
+
+GoL& GoL::startRecording(const string& filePath)
+{
+    recorder.reset(); // close the last recording first
+    recorder.reset(new RecordWriter(filePath, rule));
+    capture();
+    return *this;
+}
+
+GoL& GoL::stopRecording()
+{
+    if (!recorder) return *this;
+    const bool written = recorder->close();
+    recorder.reset();
+    if (!written) throw runtime_error("Failed to write the recording");
+    return *this;
+}
+
+bool GoL::isRecording() const
+{
+    return recorder != nullptr;
+}
+
+void GoL::capture()
+{
+    if (!recorder) return;
+    GOL_PHASE(stats.get(), PHASE_RECORD);
+    engine->store(recorder->getNext());
+    recorder->commit(currentGeneration);
+}
+
+void GoL::hash()
+{
+    GOL_PHASE(stats.get(), PHASE_HASH);
+    cycles.record(currentGeneration, engine->getHash());
+}
+
+void GoL::pushHistory()
+{
+    if (history.getBudget() == 0) return;
+    GOL_PHASE(stats.get(), PHASE_HISTORY);
+    // a universe larger than the whole budget is not kept, revert() re-simulates from an older state
+    if (!engine->storeUniverse(snapshot, history.getBudget())) return;
+    history.push(currentGeneration, snapshot);
+}
+
+GoL& GoL::run()
+{
+    if (flDetectCycles && cycles.getLatestGeneration() != currentGeneration) hash();
+    pushHistory();
     {
-        for (int j = 1; j <= getColumns(); ++j)
-        {
-            Cell& c = getCell(i, j);
-            c.setNextState(c.calculateNextState());
-        }
+        GOL_PHASE(stats.get(), PHASE_STEP);
+        engine->step();
+    }
+    ++currentGeneration;
+#ifdef GOL_STATS
+    if (stats)
+    {
+        uint64_t born, died;
+        engine->getChanges(born, died);
+        stats->addGenerations(1, engine->getEvaluatedCells(), born + died);
     }
+#endif
+    if (flDetectCycles) hash();
+    capture();
+    checkpoint();
+    return *this;
 }
 
-void GoL::applyNextGeneration()
+GoL& GoL::display(const bool& border)
 {
-    for (int i = 1; i <= getLines(); ++i)
+    const string borderString = CommonUtil::toString(STATE_BORDER);
+    const int top = engine->getOriginLine(), left = engine->getOriginColumn();
+    if (border)
     {
-        for (int j = 1; j <= getColumns(); ++j)
-        {
-            Cell& c = getCell(i, j);
-            c.setState(c.getNextState());
-        }
+        for (int j = 0; j != getColumns() + 2; ++j)
+            cout << borderString;
+        cout << '\n';
     }
+    for (int i = 0; i != getLines(); ++i)
+    {
+        if (border) cout << borderString;
+        for (int j = 0; j != getColumns(); ++j)
+            cout << CommonUtil::toString(engine->getStateOf(top + i, left + j));
+        if (border) cout << borderString;
+        cout << '\n';
+    }
+    if (border)
+    {
+        for (int j = 0; j != getColumns() + 2; ++j)
+            cout << borderString;
+        cout << '\n';
+    }
+    cout.flush();
+    return *this;
 }
 
-void GoL::cacheCellNeighbours()
+GoL& GoL::setCycleDetection(const bool& status)
 {
-    if (flNoBorder)
-        for (int i = 1; i <= getLines(); ++i)
-            for (int j = 1; j <= getColumns(); ++j)
-            {
-                Cell& c = cells[i][j];
-                c.setNeighbour(&(cells[t(i - 1, getLines())][t(j - 1, getColumns())]))
-                 .setNeighbour(&(cells[t(i - 1, getLines())][t(j, getColumns())]))
-                 .setNeighbour(&(cells[t(i - 1, getLines())][t(j + 1, getColumns())]))
-                 .setNeighbour(&(cells[t(i, getLines())][t(j - 1, getColumns())]))
-                 .setNeighbour(&(cells[t(i, getLines())][t(j + 1, getColumns())]))
-                 .setNeighbour(&(cells[t(i + 1, getLines())][t(j - 1, getColumns())]))
-                 .setNeighbour(&(cells[t(i + 1, getLines())][t(j, getColumns())]))
-                 .setNeighbour(&(cells[t(i + 1, getLines())][t(j + 1, getColumns())]));
-            }
-    else
-        for (int i = 1; i <= getLines(); ++i)
-            for (int j = 1; j <= getColumns(); ++j)
-            {
-                Cell& c = cells[i][j];
-                c.setNeighbour(&(cells[i - 1][j - 1]))
-                 .setNeighbour(&(cells[i - 1][j]))
-                 .setNeighbour(&(cells[i - 1][j + 1]))
-                 .setNeighbour(&(cells[i][j - 1]))
-                 .setNeighbour(&(cells[i][j + 1]))
-                 .setNeighbour(&(cells[i + 1][j - 1]))
-                 .setNeighbour(&(cells[i + 1][j]))
-                 .setNeighbour(&(cells[i + 1][j + 1]));
-            }
+    flDetectCycles = status;
+    cycles.clear();
+    return *this;
 }
 
-GoL& GoL::display(const bool& border)
+int GoL::getPeriod() const
 {
-    if (border)
-        for (int i = 0; i != lines; ++i)
-        {
-            for (int j = 0; j != columns; ++j)
-                cout << cells[i][j].toString();
-            cout << endl;
-        }
-    else
-        for (int i = 1; i <= getLines(); ++i)
-        {
-            for (int j = 1; j <= getColumns(); ++j)
-                cout << cells[i][j].toString();
-            cout << endl;
-        }
-    return *this;
+    return cycles.getPeriod();
+}
+
+int GoL::getCycleStart() const
+{
+    return cycles.getCycleStart();
+}
+
+void GoL::store(BitBoard& board) const
+{
+    engine->store(board);
+}
+
+uint64_t GoL::getPopulation() const
+{
+    return engine->getPopulation();
+}
+
+void GoL::getChanges(uint64_t& born, uint64_t& died) const
+{
+    engine->getChanges(born, died);
+}
+
+bool GoL::getBoundingBox(int& firstLine, int& firstColumn, int& lastLine, int& lastColumn) const
+{
+    int top, left, bottom, right;
+    if (!engine->getBoundingBox(top, left, bottom, right)) return false;
+    firstLine = top + 1;
+    firstColumn = left + 1;
+    lastLine = bottom;
+    lastColumn = right;
+    return true;
 }
 
 int GoL::getCurrentGeneration() const
@@ -190,12 +446,35 @@ int GoL::getCurrentGeneration() const
 
 int GoL::getLines() const
 {
-    return lines - 2;
+    return engine ? engine->getLines() : 0;
 }
 
 int GoL::getColumns() const
 {
-    return columns - 2;
+    return engine ? engine->getColumns() : 0;
+}
+
+void GoL::getTileStats(long& active, long& total) const
+{
+    if (engine)
+        engine->getTileStats(active, total);
+    else
+        active = total = 0;
+}
+
+bool GoL::isUnbounded() const
+{
+    return engine && engine->isUnbounded();
+}
+
+int GoL::getOriginLine() const
+{
+    return engine ? engine->getOriginLine() + 1 : 1;
+}
+
+int GoL::getOriginColumn() const
+{
+    return engine ? engine->getOriginColumn() + 1 : 1;
 }
 
 bool GoL::isNoBorder() const
@@ -203,50 +482,232 @@ bool GoL::isNoBorder() const
     return flNoBorder;
 }
 
-Cell& GoL::getCell(const int& line, const int& column)
+void GoL::locate(const int& line, const int& column, int& engineLine, int& engineColumn) const
 {
-    if (flNoBorder)
-        return cells[t(line, getLines())][t(column, getColumns())];
+    if (engine->isUnbounded())
+    {
+        engineLine = line - 1;
+        engineColumn = column - 1;
+        return;
+    }
+
+    const int lines = getLines(), columns = getColumns();
+    if (line >= 1 && line <= lines && column >= 1 && column <= columns)
+    {
+        engineLine = line - 1;
+        engineColumn = column - 1;
+        return;
+    }
+
+    // only wrap the locations outside the board
+    if (!flNoBorder) throw out_of_range("Location out of bounds");
+    engineLine = t(line, lines) - 1;
+    engineColumn = t(column, columns) - 1;
+}
 
-    if ((line < 1 || line > getLines()) || (column < 1 || column > getColumns()))
-        throw out_of_range("Location out of bounds");
-    return cells[line][column];
+CellState GoL::getStateOf(const int& line, const int& column) const
+{
+    int l, c;
+    locate(line, column, l, c);
+    return engine->getStateOf(l, c);
 }
 
 void GoL::setStateOf(const int& line, const int& column, CellState state)
 {
-    if (flNoBorder)
-        cells[t(line, getLines())][t(column, getColumns())].setState(state);
+    int l, c;
+    locate(line, column, l, c);
+    engine->setStateOf(l, c, state);
+    cycles.clear();
+}
+
+void GoL::place(const int& line, const int& column, const int& lines, const int& columns,
+                const function<void(const int&, const int&)>& at)
+{
+    // in 64 bits, a location far from the board must not overflow
+    const int64_t y = (int64_t) line - 1, x = (int64_t) column - 1;
+    if (engine->isUnbounded())
+    {
+        const int64_t top = min(y, (int64_t) snapshot.getOriginLine());
+        const int64_t left = min(x, (int64_t) snapshot.getOriginColumn());
+        const int64_t bottom = max(y + lines, (int64_t) snapshot.getOriginLine() + snapshot.getLines());
+        const int64_t right = max(x + columns, (int64_t) snapshot.getOriginColumn() + snapshot.getColumns());
+        if (top != snapshot.getOriginLine() || left != snapshot.getOriginColumn()
+            || bottom - top != snapshot.getLines() || right - left != snapshot.getColumns())
+        {
+            if (top < INT_MIN || left < INT_MIN || bottom > INT_MAX || right > INT_MAX
+                || (uint64_t) (bottom - top) * (uint64_t) ((right - left + 63) / 64) > MAX_REGION_BYTES / sizeof(uint64_t))
+                throw runtime_error("The rectangle is too far from the live cells");
+            BitBoard grown((int) (bottom - top), (int) (right - left));
+            grown.setOrigin((int) top, (int) left);
+            grown.paste(snapshot, snapshot.getOriginLine() - (int) top, snapshot.getOriginColumn() - (int) left, false);
+            snapshot = std::move(grown);
+        }
+        at((int) (y - snapshot.getOriginLine()), (int) (x - snapshot.getOriginColumn()));
+        return;
+    }
+    const int height = getLines(), width = getColumns();
+    if (!flNoBorder)
+    {
+        if (y < height && x < width && y + lines > 0 && x + columns > 0) at((int) y, (int) x);
+        return;
+    }
+    const int top = (int) ((y % height + height) % height), left = (int) ((x % width + width) % width);
+    at(top, left);
+    if (top + lines > height) at(top - height, left);
+    if (left + columns > width) at(top, left - width);
+    if (top + lines > height && left + columns > width) at(top - height, left - width);
+}
 
-    if ((line < 1 || line > getLines()) || (column < 1 || column > getColumns()))
-        throw out_of_range("Location out of bounds");
-    cells[line][column].setState(state);
+void GoL::checkRegion(const int& lines, const int& columns) const
+{
+    if (!engine->isUnbounded())
+    {
+        if (lines > getLines() || columns > getColumns())
+            throw runtime_error("The rectangle is larger than the board");
+    }
+    else if ((uint64_t) lines * (uint64_t) ((columns + 63L) / 64) > MAX_REGION_BYTES / sizeof(uint64_t))
+        throw runtime_error("The rectangle is too large");
+}
+
+void GoL::edit(const function<void()>& change)
+{
+    engine->store(snapshot);
+    if (engineType != ENGINE_HASHLIFE)
+    {
+        change();
+        engine->load(snapshot);
+    }
+    else
+    {
+        // the universe of hashlife is larger than its cell board, only set the cells which changed
+        const BitBoard before = snapshot;
+        change();
+        for (int i = 0; i != snapshot.getLines(); ++i)
+            for (int w = 0; w != snapshot.getWordsPerLine(); ++w)
+                for (uint64_t bits = before.line(i)[w] ^ snapshot.line(i)[w]; bits; bits &= bits - 1)
+                {
+                    const int j = w * 64 + __builtin_ctzll(bits);
+                    engine->setStateOf(i, j, snapshot.get(i, j) ? STATE_ALIVE : STATE_DEAD);
+                }
+    }
+    cycles.clear();
+}
+
+GoL& GoL::fill(const int& line, const int& column, const int& lines, const int& columns, const CellState& state)
+{
+    if (lines < 1 || columns < 1) return *this;
+    checkRegion(lines, columns);
+    edit([&]() {
+        place(line, column, lines, columns, [&](const int& top, const int& left) {
+            snapshot.fill(top, left, top + lines, left + columns, state == STATE_ALIVE);
+        });
+    });
+    return *this;
+}
+
+GoL& GoL::randomize(const int& line, const int& column, const int& lines, const int& columns,
+                    const double& density, const uint64_t& seed)
+{
+    if (lines < 1 || columns < 1) return *this;
+    checkRegion(lines, columns);
+    mt19937_64 random(seed);
+    edit([&]() {
+        place(line, column, lines, columns, [&](const int& top, const int& left) {
+            snapshot.randomize(top, left, top + lines, left + columns, density, random);
+        });
+    });
+    return *this;
+}
+
+GoL& GoL::copy(const int& line, const int& column, const int& lines, const int& columns,
+               const int& toLine, const int& toColumn, const bool& move)
+{
+    if (lines < 1 || columns < 1) return *this;
+    checkRegion(lines, columns);
+    edit([&]() {
+        BitBoard piece(lines, columns);
+        place(line, column, lines, columns, [&](const int& top, const int& left) {
+            piece.paste(snapshot, -top, -left, true);
+        });
+        if (move)
+            place(line, column, lines, columns, [&](const int& top, const int& left) {
+                snapshot.fill(top, left, top + lines, left + columns, false);
+            });
+        place(toLine, toColumn, lines, columns, [&](const int& top, const int& left) {
+            snapshot.paste(piece, top, left, false);
+        });
+    });
+    return *this;
+}
+
+GoL& GoL::stamp(const string& filePath, const int& line, const int& column, const int& symmetry)
+{
+    if (symmetry < 0 || symmetry > 7) throw runtime_error("Symmetry must be 0-7");
+    BitBoard pattern;
+    Rule fileRule;
+    long generation;
+    read(filePath, pattern, fileRule, generation);
+    pattern = pattern.transformed(symmetry);
+    edit([&]() {
+        place(line, column, pattern.getLines(), pattern.getColumns(), [&](const int& top, const int& left) {
+            snapshot.paste(pattern, top, left, true);
+        });
+    });
+    return *this;
 }
 
 GoL& GoL::toggleNoBorder(const bool& status)
 {
     flNoBorder = status;
+    if (engine) engine->setNoBorder(status);
     return *this;
 }
 
 GoL& GoL::revert(const int& steps)
 {
     if (steps < 1) return *this;
-    for (int i = 0; i != steps; ++i)
+    const int target = currentGeneration - steps;
+    const int restored = history.pop(target, snapshot);
+    if (restored >= 0)
     {
-        if (previousCells.empty())
-            break;
-        cells.swap(previousCells.top());
-        previousCells.pop();
-        --currentGeneration;
+        engine->loadUniverse(snapshot);
+        currentGeneration = restored;
+        cycles.clear();
+        // only the states before the jumps are kept, re-simulate the rest
+        if (restored < target)
+            forward(target - restored);
+        else
+            capture();
     }
-    cacheCellNeighbours(); // remake neighbour cache after reverting to avoid some wild pointer issues
     return *this;
 }
 
 GoL& GoL::forward(const int& steps)
 {
-    if (steps > 0)
+    if (steps < 1) return *this;
+    if (canJump())
+    {
+        pushHistory();
+        if (engine->canJump())
+        {
+            GOL_PHASE(stats.get(), PHASE_STEP);
+            engine->forward(steps);
+        }
+        else
+        {
+            GOL_PHASE(stats.get(), PHASE_STEP);
+            engine->store(snapshot);
+            SlabRunner(processes).setRule(rule).toggleNoBorder(flNoBorder).forward(snapshot, steps);
+            engine->load(snapshot);
+        }
+        currentGeneration += steps;
+#ifdef GOL_STATS
+        if (stats) stats->addGenerations(steps, 0, 0);
+#endif
+        capture();
+        checkpoint();
+    }
+    else
         for (int i = 0; i != steps; ++i)
             run();
     return *this;
@@ -5,54 +5,204 @@
 #ifndef GOL_GOL_H
 #define GOL_GOL_H
 
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <vector>
-#include <stack>
-#include "Cell.h"
+#include "Engine.h"
+#include "Checkpointer.h"
+#include "CycleTable.h"
+#include "History.h"
+#include "RecordFile.h"
+#include "Stats.h"
 
 using std::vector;
-using std::stack;
 
 /**
- * The Game of Life simulation engine, designed with singleton pattern.
+ * The Game of Life simulation engine. An instance owns its cell board,
+ * threads and history and shares nothing with the others, so any number
+ * of boards can be simulated at once (see BatchRunner).
  */
 class GoL
 {
 private:
+    /**
+     * The most memory a region operation may take on an unbounded universe, for the
+     * rectangle and for the snapshot grown to hold it.
+     */
+    static const size_t MAX_REGION_BYTES = (size_t) 1 << 28;
+
     bool flNoBorder = false;
-    int currentGeneration = 0, lines = 0, columns = 0;
-    vector<vector<Cell>> cells; // the cell board
-    stack<vector<vector<Cell>>> previousCells; // the previous state of the cell board
+    bool flDetectCycles = false;
+    bool flVerbose = true;
+    int currentGeneration = 0;
+    EngineType engineType = ENGINE_CELL;
+    Rule rule; // B3/S23 unless changed
+    size_t hashLifeLimit = (size_t) 1 << 30; // the memory limit of the hashlife engine
+    int processes = 1; // the worker processes forward() spreads bounded boards across
+    std::unique_ptr<Engine> engine; // the cell board and the stepping algorithm
+    std::unique_ptr<ThreadPool> pool; // the worker threads, null if single-threaded
+    History history; // the previous states of the cell board
+    BitBoard snapshot; // reused buffer for recording and restoring states
+    CycleTable cycles; // the hashes of the recent generations
+    std::unique_ptr<RecordWriter> recorder; // null unless recording
+    std::unique_ptr<Checkpointer> checkpointer; // null unless checkpointing
+    std::unique_ptr<Stats> stats; // null unless collecting stats
 
-    GoL() = default;
+    /**
+     * Converts a location to 0-based, wrapping it around the board when the
+     * transparent border is enabled.
+     * @throws std::out_of_range if the board is bounded, the border is enabled
+     * and the location is out of bounds.
+     */
+    void locate(const int& line, const int& column, int& engineLine, int& engineColumn) const;
 
-    ~GoL() = default;
+    /**
+     * Initializes the cell board with the cells of a loaded board, grown to at least 2*2.
+     */
+    void setup(BitBoard& board);
+
+    /**
+     * Records the hash of the current generation for the cycle detection.
+     */
+    void hash();
 
     /**
-     * Let each cell calculate and set its next state.
+     * Pushes the current state to the history, unless undo is disabled.
      */
-    void calculateNextGeneration();
+    void pushHistory();
 
     /**
-     * Let each cell apply its next state and finally let the
-     * generation counter +1, i.e., complete an iteration.
+     * Records the current generation if recording.
      */
-    void applyNextGeneration();
+    void capture();
 
     /**
-     * Set each (non-border) cell's neighbour cache.
+     * Takes a checkpoint of the current generation if one is due.
      */
-    void cacheCellNeighbours();
+    void checkpoint();
+
+    /**
+     * Loads a board from a file of any supported format, see init().
+     * @param fileRule Receives the rule saved in the file, unchanged if there is none.
+     * @param generation Receives the generation saved in the file, 0 if there is none.
+     */
+    void read(const std::string& filePath, BitBoard& board, Rule& fileRule, long& generation) const;
+
+    /**
+     * Edits the cell board through the snapshot: stores it, calls change() and puts the
+     * snapshot back. Forgets the recent hashes, like setStateOf().
+     */
+    void edit(const std::function<void()>& change);
+
+    /**
+     * Finds where a rectangle at a location (starting from 1) lands on the snapshot, and
+     * calls at() with the 0-based location of its top-left cell on it: once, or once for
+     * each side of the board it crosses when the border is transparent. The snapshot of
+     * an unbounded universe is grown to hold the rectangle first. The parts out of the
+     * snapshot are to be dropped, at() is not called if the rectangle misses a bordered board.
+     * @throws std::runtime_error if the grown snapshot would take more than MAX_REGION_BYTES.
+     */
+    void place(const int& line, const int& column, const int& lines, const int& columns,
+               const std::function<void(const int&, const int&)>& at);
+
+    /**
+     * Checks the size of a rectangle for a region operation.
+     * @throws std::runtime_error if it is larger than a bounded board, or would take more
+     * than MAX_REGION_BYTES on an unbounded universe.
+     */
+    void checkRegion(const int& lines, const int& columns) const;
 
 public:
+    GoL() = default;
+
     GoL(const GoL&) = delete;
 
+    GoL(GoL&&) = default;
+
     GoL& operator =(const GoL&) = delete;
 
+    GoL& operator =(GoL&&) = default;
+
+    ~GoL() = default;
+
+    /**
+     * Turns on/off the progress messages printed while initializing, on by default.
+     */
+    GoL& setVerbose(const bool& status);
+
+    /**
+     * Selects the simulation engine. Takes effect on the next init(). The fixed-size
+     * engine is used for the board sizes which have one (see createFixedEngine()),
+     * the cell engine for the others.
+     */
+    GoL& setEngine(const EngineType& type);
+
+    EngineType getEngine() const;
+
+    /**
+     * Sets the rule of the simulation, takes effect at once. Loading a file
+     * which carries a rule replaces it.
+     * @throws std::runtime_error if the engine does not support the rule.
+     */
+    GoL& setRule(const Rule& newRule);
+
+    const Rule& getRule() const;
+
+    /**
+     * Sets the maximum bytes used by the node table of the hashlife engine.
+     * Takes effect on the next init().
+     */
+    GoL& setHashLifeLimit(const size_t& bytes);
+
     /**
-     * Gets the instance of the engine.
+     * Sets how many threads are used to step the cell board.
+     * @param threads The number of threads, 1 to step on the calling thread only.
      */
-    static GoL& getInstance();
+    GoL& setThreads(const int& threads);
+
+    int getThreads() const;
+
+    /**
+     * Sets how many worker processes forward() spreads a bounded cell board across
+     * (see SlabRunner). Single iterations (run()) are always done in this process.
+     * @param count The number of processes, 1 to step in this process only.
+     * @throws std::runtime_error if the number is less than 1, or worker processes
+     * are not supported on this platform.
+     */
+    GoL& setProcesses(const int& count);
+
+    int getProcesses() const;
+
+    /**
+     * Does forward() advance many generations at once instead of iterating them one
+     * by one? True for the hashlife engine, and for worker processes.
+     */
+    bool canJump() const;
+
+    /**
+     * Sets the memory budget of the undo history. The oldest states are
+     * dropped when the budget is exceeded.
+     * @param bytes The budget in bytes, 0 to disable undo.
+     */
+    GoL& setHistoryLimit(const size_t& bytes);
+
+    /**
+     * How many bytes are the previous states taking?
+     */
+    size_t getHistoryBytes() const;
+
+    /**
+     * Turns on/off collecting stats (see Stats), starting them over. Nothing is collected
+     * unless built with GOL_STATS.
+     */
+    GoL& setStats(const bool& status);
+
+    /**
+     * Gets the stats being collected, null if off. The population and the history bytes
+     * are sampled by the caller.
+     */
+    Stats* getStats() const;
 
     /**
      * Initialize an empty cell board with a specified size
@@ -62,17 +212,60 @@ public:
     GoL& init(const int& initLines, const int& initColumns);
 
     /**
-     * Initialize the cell board from an input file.
+     * Initialize the cell board from an input file. Binary board files
+     * are detected by their magic and also restore the generation, RLE
+     * (.rle) and plaintext (.cells) patterns are detected by extension.
+     * The rule is replaced by the one in the file if it has one.
      * @param initFilePath The path of the input file.
      */
     GoL& init(const std::string& initFilePath);
 
     /**
-     * Save the cell board to a local file.
+     * Initialize the cell board with the cells of a board, grown to at least 2*2.
+     * The origin of the board is kept if the universe is unbounded.
+     */
+    GoL& init(const BitBoard& initBoard);
+
+    /**
+     * Save the cell board to a local file. The format is chosen by the
+     * extension: binary (.golb), RLE (.rle), plaintext (.cells), otherwise
+     * the text format of the input files. With hashlife the live cells out of
+     * the cell board are saved too, the board grows to hold them when loaded.
      * @param filePath The path of the file
+     * @throws std::runtime_error if the file can not be written.
      */
     GoL& save(const std::string& filePath);
 
+    /**
+     * Saves a checkpoint (see Checkpointer) every some generations while running,
+     * without waiting for it to be written. Resume from a checkpoint by passing the
+     * path from Checkpointer::findLatest() to init().
+     * @param every Generations between the checkpoints, 0 to stop checkpointing.
+     * @throws std::runtime_error if the directory can not be created.
+     */
+    GoL& setCheckpoints(const std::string& directory, const int& every);
+
+    /**
+     * Gets why the last checkpoint failed, empty if it did not or not checkpointing.
+     */
+    std::string getCheckpointError() const;
+
+    /**
+     * Starts recording every generation to a file (.golr, see RecordWriter), beginning
+     * with the current one. The file is written in the background. Engines able to
+     * jump only record the generations they jumped to.
+     * @throws std::runtime_error if the file can not be written.
+     */
+    GoL& startRecording(const std::string& filePath);
+
+    /**
+     * Writes the rest of the recording and closes it, does nothing if not recording.
+     * @throws std::runtime_error if the recording failed to be written.
+     */
+    GoL& stopRecording();
+
+    bool isRecording() const;
+
     /**
      * Do an iteration.
      */
@@ -84,6 +277,47 @@ public:
      */
     GoL& display(const bool& border);
 
+    /**
+     * Turns on/off detecting still lifes and cycles. When on, the cell board is hashed
+     * after each iteration, which is almost free for the engines which keep the hash
+     * up to date (bitpacked and sparse).
+     */
+    GoL& setCycleDetection(const bool& status);
+
+    /**
+     * Gets the period of the cycle the cell board is in, 1 for a still life,
+     * 0 if no cycle has been found or the detection is off.
+     */
+    int getPeriod() const;
+
+    /**
+     * Gets the first generation of the cycle the cell board is in.
+     */
+    int getCycleStart() const;
+
+    /**
+     * Copies the cell board into a bit-packed board.
+     */
+    void store(BitBoard& board) const;
+
+    /**
+     * Counts the live cells on the cell board, at once unless the engine is hashlife.
+     */
+    uint64_t getPopulation() const;
+
+    /**
+     * How many cells were born and how many died in the last iteration? Both are 0 after
+     * a jump of the hashlife engine.
+     */
+    void getChanges(uint64_t& born, uint64_t& died) const;
+
+    /**
+     * Finds the bounding box of the live cells, at once unless the engine is hashlife.
+     * The locations start from 1 like getStateOf(), and the last ones are included.
+     * @return false if there is no live cell.
+     */
+    bool getBoundingBox(int& firstLine, int& firstColumn, int& lastLine, int& lastColumn) const;
+
     int getCurrentGeneration() const;
 
     /**
@@ -98,17 +332,36 @@ public:
      */
     int getColumns() const;
 
+    /**
+     * How many tiles were recalculated in the last iteration, and how many tiles are there?
+     * Both are 0 if the engine does not skip unchanged tiles.
+     */
+    void getTileStats(long& active, long& total) const;
+
+    /**
+     * Check if the universe is an infinite plane. If so, the cell board is the
+     * bounding box of the live cells, and cells can be read and set anywhere.
+     */
+    bool isUnbounded() const;
+
+    /**
+     * Gets the location of the top-left cell of the cell board, always 1 if the universe is bounded.
+     */
+    int getOriginLine() const;
+
+    int getOriginColumn() const;
+
     /**
      * Check if the cell board has transparent border enabled.
      */
     bool isNoBorder() const;
 
     /**
-     * Gets the reference of a cell at the specified location.
+     * Gets the current state of a cell at the specified location.
      * @param line Line number, start from 1.
      * @param column Column number, start from 1.
      */
-    Cell& getCell(const int& line, const int& column);
+    CellState getStateOf(const int& line, const int& column) const;
 
     /**
      * Sets the current state of a cell at the specified location.
@@ -118,6 +371,44 @@ public:
      */
     void setStateOf(const int& line, const int& column, CellState state);
 
+    /**
+     * Sets all cells of a rectangle. The whole board is edited at once a line at a time,
+     * like the other region operations below. The cells out of a bounded board are
+     * dropped, they wrap around when the border is transparent.
+     * @param line The line of the top-left cell, start from 1.
+     * @param column The column of the top-left cell, start from 1.
+     * @throws std::runtime_error if the rectangle is larger than a bounded board, or too large
+     * or too far from the live cells of an unbounded universe.
+     */
+    GoL& fill(const int& line, const int& column, const int& lines, const int& columns, const CellState& state);
+
+    /**
+     * Sets each cell of a rectangle alive with a probability and dead otherwise.
+     * @param density The probability, rounded to 1/256.
+     * @param seed The same seed always gives the same cells.
+     * @throws std::runtime_error like fill().
+     */
+    GoL& randomize(const int& line, const int& column, const int& lines, const int& columns,
+                   const double& density, const uint64_t& seed);
+
+    /**
+     * Copies the cells of a rectangle (dead ones included) to another location, the rectangles may overlap.
+     * @param move Also kill the cells of the source rectangle which are not overwritten.
+     * @throws std::runtime_error like fill().
+     */
+    GoL& copy(const int& line, const int& column, const int& lines, const int& columns,
+              const int& toLine, const int& toColumn, const bool& move);
+
+    /**
+     * Adds the live cells of a pattern file onto the board, the rule in the file is ignored.
+     * @param line The line of the top-left cell of the pattern, start from 1.
+     * @param column The column of the top-left cell of the pattern, start from 1.
+     * @param symmetry 0-7, flipped left to right first if 4-7, then rotated by 90 degrees
+     * clockwise (symmetry & 3) times, see BitBoard::transformed().
+     * @throws std::runtime_error if the file can not be read or the symmetry is not 0-7.
+     */
+    GoL& stamp(const std::string& filePath, const int& line, const int& column, const int& symmetry);
+
     /**
      * Turns on/off the border. When the border is turned off, it becomes
      * 'transparent', which means the two sides of the cell board are
@@ -128,12 +419,15 @@ public:
     GoL& toggleNoBorder(const bool& status);
 
     /**
-     * Undo a specified amount of iterations.
+     * Undo a specified amount of iterations. Stops at the oldest state kept
+     * in the history.
      */
     GoL& revert(const int& steps);
 
     /**
-     * Do a specified amount of iterations.
+     * Do a specified amount of iterations. If able to jump (see canJump()), they are
+     * done at once, and only the state before the jump is kept in the history.
+     * @throws std::runtime_error if a worker process fails.
      */
     GoL& forward(const int& steps);
 };
@@ -0,0 +1,475 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include "HashLifeEngine.h"
+
+using namespace std;
+
+const uint32_t HashLifeEngine::NONE;
+
+HashLifeEngine::HashLifeEngine(const size_t& memoryLimit)
+{
+    this->memoryLimit = memoryLimit;
+}
+
+uint64_t HashLifeEngine::hash(const uint32_t& nw, const uint32_t& ne, const uint32_t& sw, const uint32_t& se)
+{
+    uint64_t h = nw * 0x9E3779B97F4A7C15ULL ^ ne * 0xC2B2AE3D27D4EB4FULL
+                 ^ sw * 0x165667B19E3779F9ULL ^ se * 0x27D4EB2F165667C5ULL;
+    return h ^ (h >> 29);
+}
+
+uint32_t HashLifeEngine::join(const uint32_t& nw, const uint32_t& ne, const uint32_t& sw, const uint32_t& se)
+{
+    const size_t mask = table.size() - 1;
+    size_t i = hash(nw, ne, sw, se) & mask;
+    for (; table[i] != NONE; i = (i + 1) & mask)
+    {
+        const Node& n = nodes[table[i]];
+        if (n.nw == nw && n.ne == ne && n.sw == sw && n.se == se)
+            return table[i];
+    }
+
+    if (flLimited && getBytes() > memoryLimit) throw runtime_error("The hashlife engine has reached its memory limit");
+    Node n;
+    n.nw = nw;
+    n.ne = ne;
+    n.sw = sw;
+    n.se = se;
+    n.result = NONE;
+    n.level = nodes[nw].level + 1;
+    n.population = nodes[nw].population + nodes[ne].population + nodes[sw].population + nodes[se].population;
+    nodes.push_back(n);
+    const uint32_t index = (uint32_t) nodes.size() - 1;
+    table[i] = index;
+
+    if (++tableCount * 2 > table.size()) // keep the load factor under 1/2
+    {
+        table.assign(table.size() * 2, NONE);
+        for (uint32_t j = 2; j != nodes.size(); ++j)
+            insert(j);
+    }
+    return index;
+}
+
+void HashLifeEngine::insert(const uint32_t& index)
+{
+    const Node& n = nodes[index];
+    const size_t mask = table.size() - 1;
+    size_t i = hash(n.nw, n.ne, n.sw, n.se) & mask;
+    while (table[i] != NONE)
+        i = (i + 1) & mask;
+    table[i] = index;
+}
+
+uint32_t HashLifeEngine::empty(const int& level)
+{
+    while ((int) empties.size() <= level)
+    {
+        const uint32_t e = empties.back();
+        empties.push_back(join(e, e, e, e));
+    }
+    return empties[level];
+}
+
+uint32_t HashLifeEngine::centre(const uint32_t& n)
+{
+    const Node c = nodes[n];
+    return join(nodes[c.nw].se, nodes[c.ne].sw, nodes[c.sw].ne, nodes[c.se].nw);
+}
+
+uint32_t HashLifeEngine::base(const uint32_t& n)
+{
+    // unpack the 4*4 cells
+    const Node q = nodes[n];
+    const uint32_t quadrants[4] = {q.nw, q.ne, q.sw, q.se};
+    bool cells[4][4];
+    for (int k = 0; k != 4; ++k)
+    {
+        const Node& c = nodes[quadrants[k]];
+        const int y = k / 2 * 2, x = k % 2 * 2;
+        cells[y][x] = c.nw == 1;
+        cells[y][x + 1] = c.ne == 1;
+        cells[y + 1][x] = c.sw == 1;
+        cells[y + 1][x + 1] = c.se == 1;
+    }
+
+    uint32_t next[4];
+    for (int k = 0; k != 4; ++k)
+    {
+        const int y = k / 2 + 1, x = k % 2 + 1;
+        int live = 0;
+        for (int dy = -1; dy <= 1; ++dy)
+            for (int dx = -1; dx <= 1; ++dx)
+                if ((dy || dx) && cells[y + dy][x + dx]) ++live;
+        next[k] = rule.next(cells[y][x], live) ? 1 : 0;
+    }
+    return join(next[0], next[1], next[2], next[3]);
+}
+
+uint32_t HashLifeEngine::result(const uint32_t& n)
+{
+    if (nodes[n].result != NONE) return nodes[n].result;
+
+    const Node c = nodes[n]; // copy, join() may move the nodes
+    uint32_t r;
+    if (c.population == 0)
+        r = empty(c.level - 1);
+    else if (c.level == 2)
+        r = base(n);
+    else
+    {
+        // the 9 overlapping sub-squares of half the size
+        const Node a = nodes[c.nw], b = nodes[c.ne], d = nodes[c.sw], e = nodes[c.se];
+        const uint32_t n00 = c.nw, n01 = join(a.ne, b.nw, a.se, b.sw), n02 = c.ne,
+                n10 = join(a.sw, a.se, d.nw, d.ne), n11 = join(a.se, b.sw, d.ne, e.nw), n12 = join(b.sw, b.se, e.nw, e.ne),
+                n20 = c.sw, n21 = join(d.ne, e.nw, d.se, e.sw), n22 = c.se;
+
+        // at full speed both rounds advance, otherwise only the second one does
+        const bool full = c.level - 2 <= stepExponent;
+        auto first = [&](const uint32_t& x) { return full ? result(x) : centre(x); };
+        const uint32_t r00 = first(n00), r01 = first(n01), r02 = first(n02),
+                r10 = first(n10), r11 = first(n11), r12 = first(n12),
+                r20 = first(n20), r21 = first(n21), r22 = first(n22);
+
+        const uint32_t nw = result(join(r00, r01, r10, r11));
+        const uint32_t ne = result(join(r01, r02, r11, r12));
+        const uint32_t sw = result(join(r10, r11, r20, r21));
+        const uint32_t se = result(join(r11, r12, r21, r22));
+        r = join(nw, ne, sw, se);
+    }
+    nodes[n].result = r;
+    return r;
+}
+
+void HashLifeEngine::expand()
+{
+    const Node r = nodes[root];
+    const uint32_t e = empty(r.level - 1);
+    root = join(join(e, e, e, r.nw), join(e, e, r.ne, e), join(e, r.sw, e, e), join(r.se, e, e, e));
+    rootLine -= 1LL << (r.level - 1);
+    rootColumn -= 1LL << (r.level - 1);
+}
+
+void HashLifeEngine::setStepExponent(const int& exponent)
+{
+    if (exponent == stepExponent) return;
+    // the results of the nodes advancing at full speed under both steps are still valid
+    const int keep = min(exponent, stepExponent);
+    for (Node& n : nodes)
+        if (n.level - 2 > keep)
+            n.result = NONE;
+    stepExponent = exponent;
+}
+
+void HashLifeEngine::advance(const int& exponent)
+{
+    setStepExponent(exponent);
+    // the pattern must stay within the result while advancing, keep it in the centre quarter
+    while (nodes[root].level < exponent + 3 || nodes[centre(centre(root))].population != nodes[root].population)
+        expand();
+    const int level = nodes[root].level;
+    root = result(root);
+    rootLine += 1LL << (level - 2);
+    rootColumn += 1LL << (level - 2);
+}
+
+void HashLifeEngine::jump(const int& exponent)
+{
+    // the root and its location only change once a node is complete, so an advance stopped by
+    // the memory limit leaves the universe as it was and can be tried again after collecting
+    for (int attempt = 0; attempt != 2; ++attempt)
+    {
+        if (attempt != 0) collect();
+        flLimited = true;
+        try
+        {
+            advance(exponent);
+            flLimited = false;
+            return;
+        }
+        catch (const runtime_error&)
+        {
+            flLimited = false;
+        }
+    }
+    // smaller jumps need fewer nodes, and a single generation is let over the limit
+    if (exponent == 0)
+        advance(0);
+    else
+    {
+        jump(exponent - 1);
+        jump(exponent - 1);
+    }
+}
+
+void HashLifeEngine::collect()
+{
+    if (getBytes() <= memoryLimit) return;
+
+    // mark the nodes reachable from the root and the empty nodes
+    vector<bool> marked(nodes.size(), false);
+    marked[0] = marked[1] = true;
+    vector<uint32_t> pending(empties);
+    pending.push_back(root);
+    while (!pending.empty())
+    {
+        const uint32_t n = pending.back();
+        pending.pop_back();
+        if (marked[n]) continue;
+        marked[n] = true;
+        const Node& c = nodes[n];
+        pending.push_back(c.nw);
+        pending.push_back(c.ne);
+        pending.push_back(c.sw);
+        pending.push_back(c.se);
+    }
+
+    // compact the nodes, the children are always created before their parents so the order is kept
+    vector<uint32_t> moved(nodes.size(), NONE);
+    vector<Node> kept;
+    for (uint32_t i = 0; i != nodes.size(); ++i)
+        if (marked[i])
+        {
+            moved[i] = (uint32_t) kept.size();
+            Node n = nodes[i];
+            if (i > 1)
+            {
+                n.nw = moved[n.nw];
+                n.ne = moved[n.ne];
+                n.sw = moved[n.sw];
+                n.se = moved[n.se];
+            }
+            n.result = NONE;
+            kept.push_back(n);
+        }
+    nodes.swap(kept);
+    for (uint32_t& e : empties)
+        e = moved[e];
+    root = moved[root];
+
+    size_t size = 1 << 16;
+    while (size < nodes.size() * 4) size *= 2;
+    table.assign(size, NONE);
+    tableCount = nodes.size() - 2;
+    for (uint32_t i = 2; i != nodes.size(); ++i)
+        insert(i);
+}
+
+uint32_t HashLifeEngine::build(const BitBoard& board, const int& level, const int64_t& line, const int64_t& column)
+{
+    if (line >= board.getLines() || column >= board.getColumns()) return empty(level);
+    if (level == 0) return board.get((int) line, (int) column) ? 1 : 0;
+    if (level <= 6) // the square lies in one word of each line, skip it if all dead
+    {
+        const int64_t size = 1LL << level;
+        const uint64_t mask = size == 64 ? ~0ULL : (1ULL << size) - 1;
+        bool dead = true;
+        for (int64_t y = line; y != min(line + size, (int64_t) board.getLines()) && dead; ++y)
+            dead = !((board.line((int) y)[column / 64] >> (column % 64)) & mask);
+        if (dead) return empty(level);
+    }
+    const int64_t half = 1LL << (level - 1);
+    const uint32_t nw = build(board, level - 1, line, column);
+    const uint32_t ne = build(board, level - 1, line, column + half);
+    const uint32_t sw = build(board, level - 1, line + half, column);
+    const uint32_t se = build(board, level - 1, line + half, column + half);
+    return join(nw, ne, sw, se);
+}
+
+void HashLifeEngine::extract(const uint32_t& n, const int64_t& line, const int64_t& column, BitBoard& board) const
+{
+    const Node& c = nodes[n];
+    const int64_t size = 1LL << c.level;
+    if (c.population == 0 || line >= board.getLines() || column >= board.getColumns()
+        || line + size <= 0 || column + size <= 0)
+        return;
+    if (c.level == 0)
+    {
+        board.set((int) line, (int) column, true);
+        return;
+    }
+    const int64_t half = size / 2;
+    extract(c.nw, line, column, board);
+    extract(c.ne, line, column + half, board);
+    extract(c.sw, line + half, column, board);
+    extract(c.se, line + half, column + half, board);
+}
+
+void HashLifeEngine::bound(const uint32_t& n, const int64_t& line, const int64_t& column,
+                           int64_t& top, int64_t& left, int64_t& bottom, int64_t& right) const
+{
+    const Node& c = nodes[n];
+    const int64_t size = 1LL << c.level;
+    // nothing to grow if empty or within the box already
+    if (c.population == 0 || (line >= top && column >= left && line + size <= bottom && column + size <= right))
+        return;
+    if (c.level == 0)
+    {
+        top = min(top, line);
+        left = min(left, column);
+        bottom = max(bottom, line + 1);
+        right = max(right, column + 1);
+        return;
+    }
+    const int64_t half = size / 2;
+    bound(c.nw, line, column, top, left, bottom, right);
+    bound(c.ne, line, column + half, top, left, bottom, right);
+    bound(c.sw, line + half, column, top, left, bottom, right);
+    bound(c.se, line + half, column + half, top, left, bottom, right);
+}
+
+void HashLifeEngine::plant(const BitBoard& board, const int64_t& line, const int64_t& column)
+{
+    int level = 3;
+    while ((1LL << level) < max(board.getLines(), board.getColumns())) ++level;
+    root = build(board, level, 0, 0);
+    rootLine = line;
+    rootColumn = column;
+    collect();
+}
+
+uint32_t HashLifeEngine::set(const uint32_t& n, const int64_t& line, const int64_t& column, const bool& alive)
+{
+    const Node c = nodes[n];
+    if (c.level == 0) return alive ? 1 : 0;
+    const int64_t half = 1LL << (c.level - 1);
+    if (line < half)
+        return column < half ? join(set(c.nw, line, column, alive), c.ne, c.sw, c.se)
+                             : join(c.nw, set(c.ne, line, column - half, alive), c.sw, c.se);
+    return column < half ? join(c.nw, c.ne, set(c.sw, line - half, column, alive), c.se)
+                         : join(c.nw, c.ne, c.sw, set(c.se, line - half, column - half, alive));
+}
+
+void HashLifeEngine::init(const int& initLines, const int& initColumns)
+{
+    lines = initLines;
+    columns = initColumns;
+    nodes.clear();
+    Node cell = {NONE, NONE, NONE, NONE, NONE, 0, 0};
+    nodes.push_back(cell); // dead
+    cell.population = 1;
+    nodes.push_back(cell); // alive
+    table.assign(1 << 16, NONE);
+    tableCount = 0;
+    empties.assign(1, 0);
+    stepExponent = 0;
+    root = empty(3);
+    rootLine = rootColumn = 0;
+}
+
+int HashLifeEngine::getLines() const
+{
+    return lines;
+}
+
+int HashLifeEngine::getColumns() const
+{
+    return columns;
+}
+
+CellState HashLifeEngine::getStateOf(const int& line, const int& column) const
+{
+    int64_t y = line - rootLine, x = column - rootColumn;
+    uint32_t n = root;
+    int64_t size = 1LL << nodes[n].level;
+    if (y < 0 || x < 0 || y >= size || x >= size) return STATE_DEAD;
+    while (nodes[n].level != 0 && nodes[n].population != 0)
+    {
+        size /= 2;
+        const Node& c = nodes[n];
+        n = y < size ? (x < size ? c.nw : c.ne) : (x < size ? c.sw : c.se);
+        if (y >= size) y -= size;
+        if (x >= size) x -= size;
+    }
+    return n == 1 ? STATE_ALIVE : STATE_DEAD;
+}
+
+void HashLifeEngine::setStateOf(const int& line, const int& column, const CellState& state)
+{
+    if (getStateOf(line, column) == state) return;
+    for (;;)
+    {
+        const int64_t size = 1LL << nodes[root].level;
+        if (line >= rootLine && column >= rootColumn && line < rootLine + size && column < rootColumn + size)
+            break;
+        expand();
+    }
+    root = set(root, line - rootLine, column - rootColumn, state == STATE_ALIVE);
+}
+
+void HashLifeEngine::setRule(const Rule& newRule)
+{
+    if (newRule.hasBirthOnZero()) throw runtime_error("B0 rules are not supported by the hashlife engine");
+    rule = newRule;
+    for (Node& n : nodes)
+        n.result = NONE;
+}
+
+void HashLifeEngine::setNoBorder(const bool& status)
+{
+    if (status) throw runtime_error("The hashlife engine does not support the transparent border");
+}
+
+void HashLifeEngine::step()
+{
+    forward(1);
+}
+
+bool HashLifeEngine::canJump() const
+{
+    return true;
+}
+
+void HashLifeEngine::forward(const int& steps)
+{
+    for (int exponent = 0; exponent != 31; ++exponent)
+        if (steps >> exponent & 1)
+        {
+            collect();
+            jump(exponent);
+        }
+}
+
+void HashLifeEngine::store(BitBoard& board) const
+{
+    if (board.getLines() != lines || board.getColumns() != columns)
+        board = BitBoard(lines, columns);
+    else
+        board.clear();
+    extract(root, rootLine, rootColumn, board);
+}
+
+void HashLifeEngine::load(const BitBoard& board)
+{
+    plant(board, 0, 0);
+}
+
+bool HashLifeEngine::storeUniverse(BitBoard& board, const size_t& maxBytes) const
+{
+    // the cell board and the live cells out of it
+    int64_t top = 0, left = 0, bottom = lines, right = columns;
+    bound(root, rootLine, rootColumn, top, left, bottom, right);
+    if (top < INT_MIN || left < INT_MIN || bottom > INT_MAX || right > INT_MAX
+        || bottom - top > INT_MAX || right - left > INT_MAX
+        || (uint64_t) (bottom - top) * (uint64_t) ((right - left + 63) / 64) > maxBytes / sizeof(uint64_t))
+        return false;
+    board = BitBoard((int) (bottom - top), (int) (right - left));
+    board.setOrigin((int) top, (int) left);
+    extract(root, rootLine - top, rootColumn - left, board);
+    return true;
+}
+
+void HashLifeEngine::loadUniverse(const BitBoard& board)
+{
+    plant(board, board.getOriginLine(), board.getOriginColumn());
+}
+
+size_t HashLifeEngine::getBytes() const
+{
+    return nodes.capacity() * sizeof(Node) + table.size() * sizeof(uint32_t);
+}
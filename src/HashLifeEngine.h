@@ -0,0 +1,167 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_HASHLIFEENGINE_H
+#define GOL_HASHLIFEENGINE_H
+
+#include "Engine.h"
+
+/**
+ * The HashLife engine. The universe is a quadtree of canonical (hash-consed)
+ * nodes, and the future of each node is memoized, so repeated patterns are
+ * only calculated once and the board can advance by powers of 2 at a time.
+ * <br>
+ * The universe is an infinite plane and the cell board is only a viewport
+ * of it: cells moving out of the board are kept instead of being stopped
+ * by the border. The transparent border is not supported.
+ */
+class HashLifeEngine : public Engine
+{
+private:
+    static const uint32_t NONE = 0xFFFFFFFFU;
+
+    /**
+     * A square of 2^level * 2^level cells. Level 0 nodes are single cells.
+     */
+    struct Node
+    {
+        uint32_t nw, ne, sw, se; // the 4 quadrants
+        uint32_t result; // the centre after advancing, NONE if not calculated yet
+        int level;
+        uint64_t population;
+    };
+
+    int lines = 0, columns = 0;
+    std::vector<Node> nodes; // 0 and 1 are the dead and the alive cell
+    std::vector<uint32_t> table; // open addressing hash table of the nodes, NONE if the slot is free
+    std::vector<uint32_t> empties; // the empty node of each level
+    size_t tableCount = 0, memoryLimit;
+    uint32_t root = NONE;
+    int64_t rootLine = 0, rootColumn = 0; // the location of the top-left corner of the root
+    int stepExponent = 0; // a node at level n advances 2^min(n - 2, stepExponent) generations
+    bool flLimited = false; // must join() stay within the memory limit (while a jump is advancing)?
+
+    static uint64_t hash(const uint32_t& nw, const uint32_t& ne, const uint32_t& sw, const uint32_t& se);
+
+    /**
+     * Gets the canonical node with the 4 quadrants, creating it if not exists.
+     */
+    uint32_t join(const uint32_t& nw, const uint32_t& ne, const uint32_t& sw, const uint32_t& se);
+
+    /**
+     * Inserts a node into the hash table without checking for duplicates.
+     */
+    void insert(const uint32_t& index);
+
+    uint32_t empty(const int& level);
+
+    /**
+     * Gets the centre half of a node without advancing it.
+     */
+    uint32_t centre(const uint32_t& n);
+
+    /**
+     * Gets the centre half of a node advanced by 2^min(level - 2, stepExponent) generations.
+     */
+    uint32_t result(const uint32_t& n);
+
+    /**
+     * Advances the centre 2*2 of a 4*4 node by 1 generation.
+     */
+    uint32_t base(const uint32_t& n);
+
+    /**
+     * Doubles the size of the root, keeping the universe centred.
+     */
+    void expand();
+
+    /**
+     * Advances the universe by 2^exponent generations.
+     * @throws std::runtime_error if a node is created over the memory limit while it is enforced.
+     */
+    void advance(const int& exponent);
+
+    /**
+     * Advances the universe by 2^exponent generations within the memory limit, collecting and
+     * then splitting the jump in two when it does not fit.
+     */
+    void jump(const int& exponent);
+
+    /**
+     * Changes the step of the memoized results, forgetting those which are no longer valid.
+     */
+    void setStepExponent(const int& exponent);
+
+    /**
+     * Drops the nodes which are no longer reachable from the root, if the memory limit is exceeded.
+     */
+    void collect();
+
+    uint32_t build(const BitBoard& board, const int& level, const int64_t& line, const int64_t& column);
+
+    void extract(const uint32_t& n, const int64_t& line, const int64_t& column, BitBoard& board) const;
+
+    /**
+     * Grows a box (bottom and right excluded) to hold the live cells of a node.
+     */
+    void bound(const uint32_t& n, const int64_t& line, const int64_t& column,
+               int64_t& top, int64_t& left, int64_t& bottom, int64_t& right) const;
+
+    /**
+     * Replaces the universe with the cells of a board, its top-left cell landing at a location.
+     */
+    void plant(const BitBoard& board, const int64_t& line, const int64_t& column);
+
+    uint32_t set(const uint32_t& n, const int64_t& line, const int64_t& column, const bool& alive);
+
+public:
+    /**
+     * @param memoryLimit The maximum bytes of the nodes and the hash table. The memoized results
+     * are dropped when the limit is reached, between jumps or when a jump creates a node, and a
+     * jump which does not fit is split into smaller ones. A single generation may exceed it.
+     */
+    explicit HashLifeEngine(const size_t& memoryLimit);
+
+    void init(const int& initLines, const int& initColumns) override;
+
+    int getLines() const override;
+
+    int getColumns() const override;
+
+    CellState getStateOf(const int& line, const int& column) const override;
+
+    void setStateOf(const int& line, const int& column, const CellState& state) override;
+
+    /**
+     * @throws std::runtime_error if trying to turn on the transparent border.
+     */
+    void setNoBorder(const bool& status) override;
+
+    /**
+     * Forgets the memoized results.
+     * @throws std::runtime_error if the rule has B0.
+     */
+    void setRule(const Rule& newRule) override;
+
+    void step() override;
+
+    bool canJump() const override;
+
+    void forward(const int& steps) override;
+
+    void store(BitBoard& board) const override;
+
+    void load(const BitBoard& board) override;
+
+    bool storeUniverse(BitBoard& board, const size_t& maxBytes) const override;
+
+    void loadUniverse(const BitBoard& board) override;
+
+    /**
+     * How many bytes are the nodes and the hash table taking?
+     */
+    size_t getBytes() const;
+};
+
+#endif //GOL_HASHLIFEENGINE_H
@@ -0,0 +1,198 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include "History.h"
+
+using namespace std;
+
+size_t History::Entry::bytes() const
+{
+    return sizeof(Entry) + board.getWords().size() * sizeof(uint64_t)
+           + runs.size() * sizeof(uint32_t) + bits.size() * sizeof(uint64_t);
+}
+
+void History::diff(const BitBoard& before, const BitBoard& after, vector<uint32_t>& runs, vector<uint64_t>& bits)
+{
+    runs.clear();
+    bits.clear();
+    const vector<uint64_t>& a = before.getWords();
+    const vector<uint64_t>& b = after.getWords();
+    for (size_t i = 0; i != b.size(); ++i)
+    {
+        const uint64_t x = a[i] ^ b[i];
+        if (!x) continue;
+        if (!runs.empty() && runs[runs.size() - 2] + runs.back() == i)
+            ++runs.back(); // extend the current run
+        else
+        {
+            runs.push_back((uint32_t) i);
+            runs.push_back(1);
+        }
+        bits.push_back(x);
+    }
+}
+
+void History::patch(const vector<uint32_t>& runs, const vector<uint64_t>& bits, BitBoard& board)
+{
+    vector<uint64_t>& words = board.getWords();
+    const uint64_t* b = bits.data();
+    for (size_t r = 0; r < runs.size(); r += 2)
+        for (uint32_t i = runs[r], end = runs[r] + runs[r + 1]; i != end; ++i)
+            words[i] ^= *b++;
+}
+
+void History::apply(const Entry& e, BitBoard& board)
+{
+    patch(e.runs, e.bits, board);
+}
+
+void History::rebuild(const size_t& index, BitBoard& board) const
+{
+    size_t k = index;
+    while (!entries[k].keyframe) --k; // the oldest entry is always a keyframe
+    board = entries[k].board;
+    for (++k; k <= index; ++k)
+        apply(entries[k], board);
+}
+
+void History::evict()
+{
+    bool evicted = false;
+    while (used > budget && entries.size() > 1)
+    {
+        Entry& first = entries[0];
+        Entry& second = entries[1];
+        used -= first.bytes();
+        if (!second.keyframe) // the second one becomes the oldest, turn it into a keyframe
+        {
+            used -= second.bytes();
+            second.board = std::move(first.board);
+            apply(second, second.board);
+            vector<uint32_t>().swap(second.runs);
+            vector<uint64_t>().swap(second.bits);
+            second.keyframe = true;
+            used += second.bytes();
+        }
+        entries.pop_front();
+        evicted = true;
+    }
+    if (evicted)
+    {
+        runsSinceKeyframe = 0;
+        for (size_t i = entries.size(); i-- != 0 && !entries[i].keyframe;)
+            runsSinceKeyframe += entries[i].bytes();
+    }
+}
+
+void History::setBudget(const size_t& bytes)
+{
+    budget = bytes;
+    if (budget == 0)
+        clear();
+    else
+        evict();
+}
+
+size_t History::getBudget() const
+{
+    return budget;
+}
+
+size_t History::getBytes() const
+{
+    return used + latest.getWords().size() * sizeof(uint64_t);
+}
+
+size_t History::size() const
+{
+    return entries.size();
+}
+
+bool History::empty() const
+{
+    return entries.empty();
+}
+
+int History::getOldestGeneration() const
+{
+    return entries.empty() ? -1 : entries.front().generation;
+}
+
+void History::clear()
+{
+    entries.clear();
+    latest = BitBoard();
+    used = 0;
+    runsSinceKeyframe = 0;
+}
+
+void History::push(const int& generation, BitBoard& board)
+{
+    if (budget == 0) return;
+
+    entries.emplace_back();
+    Entry& e = entries.back();
+    e.generation = generation;
+    const size_t boardBytes = board.getWords().size() * sizeof(uint64_t);
+    if (entries.size() == 1 || !board.sameSizeAs(latest) || runsSinceKeyframe >= boardBytes)
+    {
+        e.keyframe = true;
+        e.board = board;
+        runsSinceKeyframe = 0;
+    }
+    else
+    {
+        diff(latest, board, e.runs, e.bits);
+        e.runs.shrink_to_fit();
+        e.bits.shrink_to_fit();
+        runsSinceKeyframe += e.bytes();
+    }
+    used += e.bytes();
+    swap(latest, board);
+    evict();
+}
+
+int History::pop(const int& generation, BitBoard& board)
+{
+    if (entries.empty()) return -1;
+
+    size_t index = entries.size() - 1;
+    while (index != 0 && entries[index].generation > generation) --index;
+
+    // walk back from the latest state if no keyframe is in the way, otherwise replay from the keyframe
+    bool backward = true;
+    for (size_t i = index + 1; i != entries.size(); ++i)
+        if (entries[i].keyframe) backward = false;
+    if (backward)
+    {
+        board = latest;
+        for (size_t i = entries.size() - 1; i != index; --i)
+            apply(entries[i], board);
+    }
+    else
+        rebuild(index, board);
+    const int restored = entries[index].generation;
+
+    // the state before the restored one becomes the latest
+    if (index != 0)
+    {
+        if (entries[index].keyframe)
+            rebuild(index - 1, latest);
+        else
+        {
+            latest = board;
+            apply(entries[index], latest);
+        }
+    }
+    else
+        latest = BitBoard();
+
+    for (size_t i = index; i != entries.size(); ++i)
+        used -= entries[i].bytes();
+    entries.erase(entries.begin() + (long) index, entries.end());
+    runsSinceKeyframe = 0;
+    for (size_t i = entries.size(); i-- != 0 && !entries[i].keyframe;)
+        runsSinceKeyframe += entries[i].bytes();
+    return restored;
+}
@@ -0,0 +1,112 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_HISTORY_H
+#define GOL_HISTORY_H
+
+#include <cstddef>
+#include <deque>
+#include "BitBoard.h"
+
+/**
+ * The previous states of the cell board, used to undo iterations.
+ * <br>
+ * Most states are stored as the XOR runs against the state before them.
+ * A full copy (keyframe) is stored once the runs since the last keyframe
+ * grow as large as the board itself, so seeking never replays more than
+ * about one board worth of runs. When the memory budget is exceeded,
+ * the oldest states are dropped.
+ */
+class History
+{
+private:
+    struct Entry
+    {
+        int generation = 0;
+        bool keyframe = false;
+        BitBoard board; // the full state if keyframe
+        std::vector<uint32_t> runs; // (first word, word count) pairs of the changed words
+        std::vector<uint64_t> bits; // the XOR of the changed words, run by run
+
+        size_t bytes() const;
+    };
+
+    std::deque<Entry> entries;
+    BitBoard latest; // the state of the last entry
+    size_t budget = 64 << 20, used = 0, runsSinceKeyframe = 0;
+
+    /**
+     * Applies the XOR runs of a non-keyframe entry to a board.
+     */
+    static void apply(const Entry& e, BitBoard& board);
+
+    /**
+     * Rebuilds the state of an entry from the nearest keyframe before it.
+     */
+    void rebuild(const size_t& index, BitBoard& board) const;
+
+    /**
+     * Drops the oldest states until the budget is met. The latest state is always kept.
+     */
+    void evict();
+
+public:
+    /**
+     * Finds the words which differ between two boards of the same size.
+     * @param runs Receives the (first word, word count) pairs of the runs of changed words.
+     * @param bits Receives the XOR of the changed words, run by run.
+     */
+    static void diff(const BitBoard& before, const BitBoard& after,
+                     std::vector<uint32_t>& runs, std::vector<uint64_t>& bits);
+
+    /**
+     * Applies the XOR runs found by diff() to a board, which turns the board before into the board after and back.
+     */
+    static void patch(const std::vector<uint32_t>& runs, const std::vector<uint64_t>& bits, BitBoard& board);
+
+    /**
+     * Sets the memory budget of the history.
+     * @param bytes The budget in bytes, 0 to disable the history.
+     */
+    void setBudget(const size_t& bytes);
+
+    size_t getBudget() const;
+
+    /**
+     * How many bytes are the stored states taking?
+     */
+    size_t getBytes() const;
+
+    /**
+     * How many states are stored?
+     */
+    size_t size() const;
+
+    bool empty() const;
+
+    /**
+     * Gets the generation of the oldest stored state.
+     */
+    int getOldestGeneration() const;
+
+    void clear();
+
+    /**
+     * Records a state. The generation must be greater than the latest recorded one.
+     * @param board The state to record. It is swapped with the previous latest state
+     * so that the caller can reuse the memory, its content is undefined afterwards.
+     */
+    void push(const int& generation, BitBoard& board);
+
+    /**
+     * Restores the latest state recorded at or before a generation (or the oldest
+     * state if there is none), and drops that state along with all states after it.
+     * @param generation The wanted generation.
+     * @param board Where the restored state will be written to.
+     * @return The generation of the restored state, -1 if the history is empty.
+     */
+    int pop(const int& generation, BitBoard& board);
+};
+
+#endif //GOL_HISTORY_H
@@ -0,0 +1,315 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "Kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GOL_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+static void lineScalar(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out,
+                       const int& begin, const int& end, const Rule& rule)
+{
+    for (int w = begin; w < end; ++w)
+        out[w] = Kernel::word((up[w] << 1) | (up[w - 1] >> 63), up[w], (up[w] >> 1) | (up[w + 1] << 63),
+                              (mid[w] << 1) | (mid[w - 1] >> 63), mid[w], (mid[w] >> 1) | (mid[w + 1] << 63),
+                              (down[w] << 1) | (down[w - 1] >> 63), down[w], (down[w] >> 1) | (down[w + 1] << 63), rule);
+}
+
+#ifdef GOL_X86_KERNELS
+
+typedef uint64_t Vector128 __attribute__((vector_size(16)));
+typedef uint64_t Vector256 __attribute__((vector_size(32)));
+typedef uint64_t Vector512 __attribute__((vector_size(64)));
+
+/**
+ * The kernel for the rules other than B3/S23, written once with the vector extension of GCC.
+ * It is always inlined, so it is compiled for the instruction set of each function using it.
+ */
+template<typename V>
+static inline __attribute__((always_inline))
+void lineRule(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out,
+              const int& begin, const int& end, const Rule& rule)
+{
+    const int lanes = sizeof(V) / sizeof(uint64_t);
+    const V zero = {};
+    V dead[9], change[9];
+    for (int n = 0; n != 9; ++n)
+    {
+        dead[n] = zero + rule.getDeadMasks()[n];
+        change[n] = zero + rule.getChangeMasks()[n];
+    }
+#define LOAD(p) ({ V v; memcpy(&v, p, sizeof(V)); v; }) // unaligned
+
+    int w = begin;
+    for (; w + lanes <= end; w += lanes)
+    {
+        const V u = LOAD(up + w), m = LOAD(mid + w), d = LOAD(down + w);
+        const V uw = (u << 1) | (LOAD(up + w - 1) >> 63), ue = (u >> 1) | (LOAD(up + w + 1) << 63);
+        const V mw = (m << 1) | (LOAD(mid + w - 1) >> 63), me = (m >> 1) | (LOAD(mid + w + 1) << 63);
+        const V dw = (d << 1) | (LOAD(down + w - 1) >> 63), de = (d >> 1) | (LOAD(down + w + 1) << 63);
+
+        const V su = uw ^ u ^ ue, cu = (uw & u) | (ue & (uw ^ u));
+        const V sm = mw ^ me, cm = mw & me;
+        const V sd = dw ^ d ^ de, cd = (dw & d) | (de & (dw ^ d));
+        const V ones = su ^ sm ^ sd, onesCarry = (su & sm) | (sd & (su ^ sm));
+        const V c = cu ^ cm ^ cd, cCarry = (cu & cm) | (cd & (cu ^ cm));
+        const V twos = c ^ onesCarry, twosCarry = c & onesCarry;
+        const V fours = cCarry ^ twosCarry, eights = cCarry & twosCarry;
+
+        // see Rule::apply()
+        V leaf[9];
+        for (int n = 0; n != 9; ++n)
+            leaf[n] = dead[n] ^ (m & change[n]);
+        const V l01 = leaf[0] ^ ((leaf[0] ^ leaf[1]) & ones), l23 = leaf[2] ^ ((leaf[2] ^ leaf[3]) & ones);
+        const V l45 = leaf[4] ^ ((leaf[4] ^ leaf[5]) & ones), l67 = leaf[6] ^ ((leaf[6] ^ leaf[7]) & ones);
+        const V l03 = l01 ^ ((l01 ^ l23) & twos), l47 = l45 ^ ((l45 ^ l67) & twos);
+        const V l07 = l03 ^ ((l03 ^ l47) & fours);
+        const V next = l07 ^ ((l07 ^ leaf[8]) & eights);
+        memcpy(out + w, &next, sizeof(V));
+    }
+#undef LOAD
+    lineScalar(up, mid, down, out, w, end, rule);
+}
+
+__attribute__((target("sse2")))
+static void lineRuleSse2(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out,
+                         const int& begin, const int& end, const Rule& rule)
+{
+    lineRule<Vector128>(up, mid, down, out, begin, end, rule);
+}
+
+__attribute__((target("avx2")))
+static void lineRuleAvx2(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out,
+                         const int& begin, const int& end, const Rule& rule)
+{
+    lineRule<Vector256>(up, mid, down, out, begin, end, rule);
+}
+
+__attribute__((target("avx512f")))
+static void lineRuleAvx512(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out,
+                           const int& begin, const int& end, const Rule& rule)
+{
+    lineRule<Vector512>(up, mid, down, out, begin, end, rule);
+}
+
+// The vector kernels load each line 3 times: at w, w - 1 and w + 1 (unaligned),
+// so that the carries between the words can be shifted in without shuffling.
+
+__attribute__((target("sse2")))
+static void lineSse2(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out,
+                     const int& begin, const int& end, const Rule& rule)
+{
+#define LOAD(p) _mm_loadu_si128((const __m128i*) (p))
+#define WEST(p) _mm_or_si128(_mm_slli_epi64(LOAD(p), 1), _mm_srli_epi64(LOAD((p) - 1), 63))
+#define EAST(p) _mm_or_si128(_mm_srli_epi64(LOAD(p), 1), _mm_slli_epi64(LOAD((p) + 1), 63))
+#define MAJ(a, b, c) _mm_or_si128(_mm_and_si128(a, b), _mm_and_si128(c, _mm_xor_si128(a, b)))
+    int w = begin;
+    for (; w + 2 <= end; w += 2)
+    {
+        const __m128i uw = WEST(up + w), u = LOAD(up + w), ue = EAST(up + w);
+        const __m128i mw = WEST(mid + w), m = LOAD(mid + w), me = EAST(mid + w);
+        const __m128i dw = WEST(down + w), d = LOAD(down + w), de = EAST(down + w);
+
+        const __m128i su = _mm_xor_si128(_mm_xor_si128(uw, u), ue), cu = MAJ(uw, u, ue);
+        const __m128i sm = _mm_xor_si128(mw, me), cm = _mm_and_si128(mw, me);
+        const __m128i sd = _mm_xor_si128(_mm_xor_si128(dw, d), de), cd = MAJ(dw, d, de);
+
+        const __m128i ones = _mm_xor_si128(_mm_xor_si128(su, sm), sd), onesCarry = MAJ(su, sm, sd);
+        const __m128i c = _mm_xor_si128(_mm_xor_si128(cu, cm), cd), cCarry = MAJ(cu, cm, cd);
+        const __m128i twos = _mm_xor_si128(c, onesCarry), twosCarry = _mm_and_si128(c, onesCarry);
+        const __m128i fours = _mm_xor_si128(cCarry, twosCarry);
+
+        _mm_storeu_si128((__m128i*) (out + w),
+                         _mm_andnot_si128(fours, _mm_and_si128(twos, _mm_or_si128(ones, m))));
+    }
+#undef MAJ
+#undef EAST
+#undef WEST
+#undef LOAD
+    lineScalar(up, mid, down, out, w, end, rule);
+}
+
+__attribute__((target("avx2")))
+static void lineAvx2(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out,
+                     const int& begin, const int& end, const Rule& rule)
+{
+#define LOAD(p) _mm256_loadu_si256((const __m256i*) (p))
+#define WEST(p) _mm256_or_si256(_mm256_slli_epi64(LOAD(p), 1), _mm256_srli_epi64(LOAD((p) - 1), 63))
+#define EAST(p) _mm256_or_si256(_mm256_srli_epi64(LOAD(p), 1), _mm256_slli_epi64(LOAD((p) + 1), 63))
+#define MAJ(a, b, c) _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_xor_si256(a, b)))
+    int w = begin;
+    for (; w + 4 <= end; w += 4)
+    {
+        const __m256i uw = WEST(up + w), u = LOAD(up + w), ue = EAST(up + w);
+        const __m256i mw = WEST(mid + w), m = LOAD(mid + w), me = EAST(mid + w);
+        const __m256i dw = WEST(down + w), d = LOAD(down + w), de = EAST(down + w);
+
+        const __m256i su = _mm256_xor_si256(_mm256_xor_si256(uw, u), ue), cu = MAJ(uw, u, ue);
+        const __m256i sm = _mm256_xor_si256(mw, me), cm = _mm256_and_si256(mw, me);
+        const __m256i sd = _mm256_xor_si256(_mm256_xor_si256(dw, d), de), cd = MAJ(dw, d, de);
+
+        const __m256i ones = _mm256_xor_si256(_mm256_xor_si256(su, sm), sd), onesCarry = MAJ(su, sm, sd);
+        const __m256i c = _mm256_xor_si256(_mm256_xor_si256(cu, cm), cd), cCarry = MAJ(cu, cm, cd);
+        const __m256i twos = _mm256_xor_si256(c, onesCarry), twosCarry = _mm256_and_si256(c, onesCarry);
+        const __m256i fours = _mm256_xor_si256(cCarry, twosCarry);
+
+        _mm256_storeu_si256((__m256i*) (out + w),
+                            _mm256_andnot_si256(fours, _mm256_and_si256(twos, _mm256_or_si256(ones, m))));
+    }
+#undef MAJ
+#undef EAST
+#undef WEST
+#undef LOAD
+    lineScalar(up, mid, down, out, w, end, rule);
+}
+
+// GCC 12 warns that the placeholder operand the AVX-512 intrinsics pass for their unused
+// mask lanes may be uninitialized, which is a false positive
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f")))
+static void lineAvx512(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out,
+                       const int& begin, const int& end, const Rule& rule)
+{
+#define LOAD(p) _mm512_loadu_si512((const void*) (p))
+#define WEST(p) _mm512_or_si512(_mm512_slli_epi64(LOAD(p), 1), _mm512_srli_epi64(LOAD((p) - 1), 63))
+#define EAST(p) _mm512_or_si512(_mm512_srli_epi64(LOAD(p), 1), _mm512_slli_epi64(LOAD((p) + 1), 63))
+#define XOR3(a, b, c) _mm512_ternarylogic_epi64(a, b, c, 0x96)
+#define MAJ(a, b, c) _mm512_ternarylogic_epi64(a, b, c, 0xE8)
+    int w = begin;
+    for (; w + 8 <= end; w += 8)
+    {
+        const __m512i uw = WEST(up + w), u = LOAD(up + w), ue = EAST(up + w);
+        const __m512i mw = WEST(mid + w), m = LOAD(mid + w), me = EAST(mid + w);
+        const __m512i dw = WEST(down + w), d = LOAD(down + w), de = EAST(down + w);
+
+        const __m512i su = XOR3(uw, u, ue), cu = MAJ(uw, u, ue);
+        const __m512i sm = _mm512_xor_si512(mw, me), cm = _mm512_and_si512(mw, me);
+        const __m512i sd = XOR3(dw, d, de), cd = MAJ(dw, d, de);
+
+        const __m512i ones = XOR3(su, sm, sd), onesCarry = MAJ(su, sm, sd);
+        const __m512i c = XOR3(cu, cm, cd), cCarry = MAJ(cu, cm, cd);
+        const __m512i twos = _mm512_xor_si512(c, onesCarry), twosCarry = _mm512_and_si512(c, onesCarry);
+        const __m512i fours = _mm512_xor_si512(cCarry, twosCarry);
+
+        // twos & ~fours & (ones | m)
+        _mm512_storeu_si512((void*) (out + w),
+                            _mm512_andnot_si512(fours, _mm512_ternarylogic_epi64(twos, ones, m, 0xE0)));
+    }
+#undef MAJ
+#undef XOR3
+#undef EAST
+#undef WEST
+#undef LOAD
+    lineScalar(up, mid, down, out, w, end, rule);
+}
+
+#pragma GCC diagnostic pop
+
+#endif
+
+/**
+ * The kernel in use and its name.
+ */
+struct KernelChoice
+{
+    Kernel::LineFunction function; // for B3/S23
+    Kernel::LineFunction ruleFunction; // for the other rules
+    const char* name;
+};
+
+static KernelChoice detect()
+{
+#ifdef GOL_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return {lineAvx512, lineRuleAvx512, "avx512"};
+    if (__builtin_cpu_supports("avx2")) return {lineAvx2, lineRuleAvx2, "avx2"};
+    if (__builtin_cpu_supports("sse2")) return {lineSse2, lineRuleSse2, "sse2"};
+#endif
+    return {lineScalar, lineScalar, "scalar"};
+}
+
+static KernelChoice& choice()
+{
+    static KernelChoice selected = detect();
+    return selected;
+}
+
+void Kernel::line(const LineFunction& kernel, const uint64_t* up, const uint64_t* mid, const uint64_t* down,
+                  uint64_t* out, const int& begin, const int& end, const int& columns, const bool& wrap,
+                  const Rule& rule)
+{
+    const int n = (columns + 63) / 64;
+    const int lastBit = (columns - 1) % 64; // the position of the last column in the last word
+
+    // shifts a line so that every cell sees its west (left) or east (right) neighbour
+    auto west = [&](const uint64_t* l, const int& w) -> uint64_t {
+        uint64_t carry = w != 0 ? l[w - 1] >> 63 :
+                         wrap ? (l[n - 1] >> lastBit) & 1ULL : 0;
+        return (l[w] << 1) | carry;
+    };
+    auto east = [&](const uint64_t* l, const int& w) -> uint64_t {
+        uint64_t carry = w != n - 1 ? l[w + 1] << 63 :
+                         wrap ? (l[0] & 1ULL) << lastBit : 0;
+        return (l[w] >> 1) | carry;
+    };
+    auto edge = [&](const int& w) {
+        out[w] = word(west(up, w), up[w], east(up, w),
+                      west(mid, w), mid[w], east(mid, w),
+                      west(down, w), down[w], east(down, w), rule);
+    };
+
+    // the first and the last word take their carries from the border, the rest go to the vector kernel
+    const int inner = max(begin, 1), innerEnd = min(end, n - 1);
+    if (begin == 0) edge(0);
+    if (inner < innerEnd) kernel(up, mid, down, out, inner, innerEnd, rule);
+    if (end == n && n > 1) edge(n - 1);
+    if (end == n && columns % 64 != 0) out[n - 1] &= (1ULL << (columns % 64)) - 1;
+}
+
+Kernel::LineFunction Kernel::get(const Rule& rule)
+{
+    return rule.isConway() ? choice().function : choice().ruleFunction;
+}
+
+const char* Kernel::getName()
+{
+    return choice().name;
+}
+
+void Kernel::select(const string& name)
+{
+    if (name == "scalar")
+    {
+        choice() = {lineScalar, lineScalar, "scalar"};
+        return;
+    }
+#ifdef GOL_X86_KERNELS
+    __builtin_cpu_init();
+    if (name == "sse2" && __builtin_cpu_supports("sse2"))
+    {
+        choice() = {lineSse2, lineRuleSse2, "sse2"};
+        return;
+    }
+    if (name == "avx2" && __builtin_cpu_supports("avx2"))
+    {
+        choice() = {lineAvx2, lineRuleAvx2, "avx2"};
+        return;
+    }
+    if (name == "avx512" && __builtin_cpu_supports("avx512f"))
+    {
+        choice() = {lineAvx512, lineRuleAvx512, "avx512"};
+        return;
+    }
+#endif
+    throw runtime_error(string("Kernel not available: ").append(name));
+}
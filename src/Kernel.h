@@ -0,0 +1,100 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_KERNEL_H
+#define GOL_KERNEL_H
+
+#include <cstdint>
+#include <string>
+#include "Rule.h"
+
+/**
+ * The line kernels of the bit-packed engine. A kernel steps a span of
+ * 64-cell words of a line, and the widest instruction set supported by
+ * the CPU is selected at startup. Each instruction set has a kernel for
+ * B3/S23 and one for any other rule.
+ */
+class Kernel
+{
+public:
+    /**
+     * Calculates the words [begin, end) of a line of the next generation.
+     * The words begin - 1 and end must exist, i.e. begin >= 1 and end < words per line.
+     * @param up The line above.
+     * @param mid The line to calculate.
+     * @param down The line below.
+     * @param out Where the next state of the line will be written to.
+     * @param rule The rule, only used by the kernels for rules other than B3/S23.
+     */
+    typedef void (*LineFunction)(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out,
+                                 const int& begin, const int& end, const Rule& rule);
+
+    /**
+     * Calculates the next state of 64 cells. Each argument is a word of neighbours,
+     * e.g. uw is the line above shifted so that every cell sees its north-west neighbour.
+     */
+    static inline uint64_t word(const uint64_t& uw, const uint64_t& u, const uint64_t& ue,
+                                const uint64_t& mw, const uint64_t& m, const uint64_t& me,
+                                const uint64_t& dw, const uint64_t& d, const uint64_t& de, const Rule& rule)
+    {
+        if (rule.isConway()) return word<true>(uw, u, ue, mw, m, me, dw, d, de, rule);
+        return word<false>(uw, u, ue, mw, m, me, dw, d, de, rule);
+    }
+
+    /**
+     * Calculates the next state of 64 cells, for callers which choose the rule once for many words.
+     * @tparam Conway Is the rule B3/S23? The rule is not read then.
+     */
+    template<bool Conway>
+    static inline uint64_t word(const uint64_t& uw, const uint64_t& u, const uint64_t& ue,
+                                const uint64_t& mw, const uint64_t& m, const uint64_t& me,
+                                const uint64_t& dw, const uint64_t& d, const uint64_t& de, const Rule& rule)
+    {
+        // add up each line of neighbours: (value = s + 2 * c)
+        const uint64_t su = uw ^ u ^ ue, cu = (uw & u) | (ue & (uw ^ u));
+        const uint64_t sm = mw ^ me, cm = mw & me;
+        const uint64_t sd = dw ^ d ^ de, cd = (dw & d) | (de & (dw ^ d));
+
+        // add up the three lines: count = ones + 2 * twos + 4 * fours (+ 8 * eights)
+        const uint64_t ones = su ^ sm ^ sd, onesCarry = (su & sm) | (sd & (su ^ sm));
+        const uint64_t c = cu ^ cm ^ cd, cCarry = (cu & cm) | (cd & (cu ^ cm));
+        const uint64_t twos = c ^ onesCarry, twosCarry = c & onesCarry;
+        const uint64_t fours = cCarry ^ twosCarry, eights = cCarry & twosCarry;
+
+        // B3/S23: alive if the count is 3, or the count is 2 and the cell is alive
+        if (Conway) return twos & ~fours & (ones | m);
+        return rule.apply(ones, twos, fours, eights, m);
+    }
+
+    /**
+     * Calculates the words [begin, end) of a line of a board of the next generation.
+     * The first and the last word take their carries from the border, or from the other
+     * side of the line if it wraps around, the rest are handed to a kernel.
+     * @param kernel The kernel from get().
+     * @param columns The columns of the board, the cells after them in the last word are cleared.
+     * @param wrap Are the two sides of the line connected (the transparent border)?
+     */
+    static void line(const LineFunction& kernel, const uint64_t* up, const uint64_t* mid, const uint64_t* down,
+                     uint64_t* out, const int& begin, const int& end, const int& columns, const bool& wrap,
+                     const Rule& rule);
+
+    /**
+     * Gets the kernel in use for a rule. The widest supported instruction set is selected at startup.
+     */
+    static LineFunction get(const Rule& rule);
+
+    /**
+     * Gets the name of the kernel in use: "avx512", "avx2", "sse2" or "scalar".
+     */
+    static const char* getName();
+
+    /**
+     * Overrides the kernel selected at startup. Must be called before any simulation starts.
+     * @param name "avx512", "avx2", "sse2" or "scalar".
+     * @throws std::runtime_error if the kernel is unknown or not supported by the CPU.
+     */
+    static void select(const std::string& name);
+};
+
+#endif //GOL_KERNEL_H
@@ -1,12 +1,61 @@
+#include <algorithm>
+#include <climits>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <csignal>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
 #include "GoL.h"
+#include "BatchRunner.h"
+#include "Census.h"
 #include "CommonUtil.h"
+#include "Kernel.h"
+#include "RecordFile.h"
+#include "Renderer.h"
+#include "TripleBuffer.h"
 
 using namespace std;
 
-static bool flInfiniteGenerations = true, flPause = false, flNoBorder = false, flShowBorder = false;
-static unsigned int sleepMs = 500;
-static unsigned long targetGeneration;
+static bool flInfiniteGenerations = true, flNoBorder = false, flShowBorder = false, flUnbounded = false;
+static bool flHeadless = false, flStopOnCycle = false;
+static string outputPath, recordPath, replayPath, resumePath, checkpointPath = "checkpoints";
+static string statsPath, tracePath;
+static int checkpointEvery = 0;
+static unsigned int sleepMs = 500, fps = 30;
+static const int HEADLESS_LIMIT = 100000; // generations of a headless run without a target
+static int threads = 1, processes = 1;
+static size_t historyMB = 64, hashMB = 1024;
+static int targetGeneration;
+static EngineType engineType = ENGINE_FIXED;
+static Rule rule;
+static bool flRule = false;
+static int batchCount = 0, batchLines = 64, batchColumns = 64, censusCount = 0;
+static uint64_t batchSeed = 1;
+static Renderer renderer;
+static BitBoard frame;
+static GoL app;
+
+/**
+ * A snapshot of the running board, passed from the simulation thread to the render thread.
+ */
+struct Frame
+{
+    BitBoard board;
+    string status;
+};
+
+static TripleBuffer<Frame> frames;
+static string statsText; // the last stats line, empty unless collecting stats
+static chrono::steady_clock::time_point statsTime; // when statsText was updated
+static atomic<bool> interrupted(false); // set by Ctrl+C
+static atomic<bool> frameWanted(false); // set by the render thread when it is ready for a new frame
+static atomic<bool> simulating(false);
+static bool stopping = false; // guarded by sessionMutex
+static mutex sessionMutex;
+static condition_variable sessionWake;
 
 /**
  * Shows the context menu, and the user can do do some
@@ -15,13 +64,189 @@ static unsigned long targetGeneration;
  * The menu will be shown at the beginning of an infinite
  * simulation and every time the user presses Ctrl+C.
  */
-void showMenu(int);
+void showMenu();
 
 /**
- * Performs the automated simulation.
+ * Performs the automated simulation. The board is stepped on a simulation
+ * thread and drawn on a render thread, while this thread waits for Ctrl+C
+ * and stops both of them before showing the menu.
  */
 void mainLoop();
 
+/**
+ * The simulation thread: steps the board, paced by sleepMs, and publishes
+ * a frame whenever the render thread is ready for one.
+ */
+void simulate();
+
+/**
+ * The render thread: draws the latest frame at most fps times per second.
+ */
+void draw();
+
+/**
+ * The handler of Ctrl+C. Only raises a flag, the menu is shown by the main thread.
+ */
+void interrupt(int)
+{
+    interrupted = true;
+    signal(SIGINT, interrupt); // why re-register? cuz windows sucks
+}
+
+/**
+ * Runs the simulation without displaying or waiting, to the target generation
+ * or until the cell board stops changing, then saves the final board and
+ * prints a summary of "key=value" pairs.
+ */
+void runHeadless();
+
+/**
+ * Plays a recording from the target generation (or the beginning), or saves the
+ * board of the target generation if headless.
+ * @return The exit code.
+ */
+int runReplay();
+
+/**
+ * Shows the menu of a paused replay.
+ * @return false if the user wants to exit.
+ */
+bool showReplayMenu(RecordReader& reader, size_t& frame, BitBoard& board);
+
+/**
+ * Simulates a batch of random soups in parallel, and prints the result of each
+ * soup and a summary as "key=value" pairs.
+ */
+void runBatch();
+
+/**
+ * Takes a census of random soups in parallel, saves the counts of the objects to the
+ * output once a second and at the end (or prints them), and prints a summary.
+ */
+void runCensus();
+
+/**
+ * Gets the current generation and the board size, and the location of the
+ * board when the universe is unbounded.
+ */
+string status()
+{
+    stringstream s;
+    s << "Current generation: " << app.getCurrentGeneration()
+      << ". Board size: " << app.getColumns() << "*" << app.getLines();
+    if (!app.getRule().isConway())
+        s << ". Rule: " << app.getRule().toString();
+    if (app.isUnbounded())
+        s << " at (" << app.getOriginColumn() << ", " << app.getOriginLine() << ")";
+    s << ". Population: " << app.getPopulation();
+    int firstLine, firstColumn, lastLine, lastColumn;
+    if (app.getBoundingBox(firstLine, firstColumn, lastLine, lastColumn))
+        s << " in (" << firstColumn << ", " << firstLine << ")-(" << lastColumn << ", " << lastLine << ")";
+    if (app.getPeriod() == 1)
+        s << ". Still life since generation " << app.getCycleStart();
+    else if (app.getPeriod() != 0)
+        s << ". Period " << app.getPeriod() << " since generation " << app.getCycleStart();
+    const string checkpointError = app.getCheckpointError();
+    if (!checkpointError.empty())
+        s << ". " << checkpointError;
+    return s.str();
+}
+
+/**
+ * Gets the location and the zoom of the viewport if it was moved.
+ */
+string viewStatus()
+{
+    if (renderer.getViewLine() == 0 && renderer.getViewColumn() == 0 && renderer.getMode() == RENDER_CELL)
+        return "";
+    stringstream view;
+    view << ". View: (" << renderer.getViewColumn() + 1 << ", " << renderer.getViewLine() + 1 << ") zoom " << renderer.getMode();
+    return view.str();
+}
+
+/**
+ * Draws the cell board through the renderer.
+ */
+void render(const string& footer)
+{
+    app.store(frame);
+    renderer.render(frame, status() + viewStatus() + footer);
+}
+
+/**
+ * Has the automated simulation reached the target generation, or a cycle if asked to stop there?
+ */
+bool finished()
+{
+    return (!flInfiniteGenerations && app.getCurrentGeneration() == targetGeneration)
+           || (flStopOnCycle && app.getPeriod() != 0);
+}
+
+/**
+ * Starts recording and checkpointing if asked to.
+ * @return false if the files can not be written.
+ */
+bool startPersisting()
+{
+    try
+    {
+        if (!recordPath.empty()) app.startRecording(recordPath);
+        app.setCheckpoints(checkpointPath, checkpointEvery);
+        return true;
+    }
+    catch (exception& e)
+    {
+        cout << e.what() << endl;
+        return false;
+    }
+}
+
+/**
+ * Updates the stats line once a second if collecting stats.
+ * @return true if it was updated.
+ */
+bool updateStats()
+{
+    Stats* stats = app.getStats();
+    if (!stats) return false;
+    const auto now = chrono::steady_clock::now();
+    if (now - statsTime < chrono::seconds(1)) return false;
+    statsTime = now;
+    stats->sample(app.getPopulation(), app.getHistoryBytes());
+    statsText = stats->getLine();
+    return true;
+}
+
+/**
+ * Starts collecting stats if asked to, once the board is ready.
+ */
+void startStats()
+{
+    if (statsPath.empty() && tracePath.empty()) return;
+    app.setStats(true);
+    app.getStats()->setTracing(!tracePath.empty());
+    statsTime = chrono::steady_clock::now();
+}
+
+/**
+ * Writes the stats and the trace if asked to, before exiting.
+ */
+void writeStats()
+{
+    Stats* stats = app.getStats();
+    if (!stats) return;
+    stats->sample(app.getPopulation(), app.getHistoryBytes());
+    try
+    {
+        if (!statsPath.empty()) stats->write(statsPath);
+        if (!tracePath.empty()) stats->writeTrace(tracePath);
+    }
+    catch (exception& e)
+    {
+        cout << e.what() << endl;
+    }
+}
+
 /**
  * Resets the standard input.
  */
@@ -40,14 +265,64 @@ int main(int argc, char** argv)
 {
     if (argc < 2) // no input file specified. print help message
     {
-        cout << "Usage: GoL <--new / initFilePath> [--targetGeneration={}] [--sleepMs={}] [--noBorder] [--showBorder]" << endl
+        cout << "Usage: GoL <--new / initFilePath / --resume={} / --batch={} / --census={} / --replay={}> [--targetGeneration={}] [--sleepMs={}] [--fps={}] [--noBorder] [--showBorder] [--engine={}] [--threads={}] [--processes={}]" << endl
+             << "           [--kernel={}] [--historyMB={}] [--hashMB={}] [--unbounded] [--headless] [--output={}] [--render={}]" << endl
+             << "           [--stopOnCycle] [--rule={}] [--seed={}] [--size={}] [--record={}] [--checkpointEvery={}] [--checkpointDir={}]" << endl
+             << "           [--stats={}] [--trace={}]" << endl
              << "Parameters:" << endl
              << " new:              Create a new empty cell board." << endl
-             << " initFilePath:     The path of the text file used for cell board initialization." << endl
-             << " targetGeneration: Maximum number of generation, default is infinite." << endl
-             << " sleepMs:          Milliseconds to wait between iterations, default is 500." << endl
+             << " initFilePath:     The path of the file used for cell board initialization. Text, binary (.golb)," << endl
+             << "                   RLE (.rle) and plaintext (.cells) files are supported." << endl
+             << " resume:           Continue from the latest valid checkpoint in a directory." << endl
+             << " batch:            Simulate this many boards of the size (64*64 by default) seeded with a random 16*16" << endl
+             << "                   soup headlessly, as many at once as the threads, and print the result of each." << endl
+             << "                   Needs the target generation." << endl
+             << " census:           Simulate this many infinite planes seeded with a random 16*16 soup (whatever the size)" << endl
+             << "                   until they settle, split what is left into objects and count them by kind (still" << endl
+             << "                   life, oscillator, spaceship). The counts are saved to the output (CSV) as they come," << endl
+             << "                   or printed at the end. The target generation is when an unsettled soup is given up," << endl
+             << "                   default is 50000." << endl
+             << " replay:           Play a recording (.golr) from the target generation, or save the board of the" << endl
+             << "                   target generation to the output if headless." << endl
+             << " targetGeneration: Maximum number of generation (up to 2147483647), default is infinite." << endl
+             << " sleepMs:          Milliseconds to wait between iterations, default is 500. 0 simulates as fast as possible." << endl
+             << " fps:              Maximum times the running board is redrawn per second, default is 30." << endl
              << " noBorder:         Turn on the transparent border feature." << endl
-             << " showBorder:       Also print the border when displaying." << endl;
+             << " showBorder:       Also print the border when displaying." << endl
+             << " engine:           The simulation engine, 'fixed' (default), 'cell', 'bitpacked', 'hashlife' or 'sparse'." << endl
+             << "                   The fixed engine is made for 16*16, 32*32 and 64*64 boards, e.g. the batches," << endl
+             << "                   and is the cell engine for the other sizes." << endl
+             << "                   The hashlife engine simulates an infinite plane and shows the board area of it," << endl
+             << "                   and jumps to the target generation at once." << endl
+             << " threads:          Number of threads used to step the cell board, default is 1." << endl
+             << " processes:        Number of local worker processes sharing a bounded board, each stepping a slab" << endl
+             << "                   of lines, default is 1. Used when going forward many generations at once," << endl
+             << "                   e.g. a headless run to the target generation." << endl
+             << " kernel:           Force the kernel of the bitpacked engine: 'avx512', 'avx2', 'sse2' or 'scalar'." << endl
+             << "                   The widest one supported by the CPU is used by default." << endl
+             << " historyMB:        Memory budget of the undo history in MiB, default is 64. 0 disables undo." << endl
+             << " hashMB:           Memory limit of the hashlife node table in MiB, default is 1024." << endl
+             << " unbounded:        Simulate an infinite plane, the board grows with the live cells." << endl
+             << "                   Uses the sparse engine unless the hashlife engine is chosen." << endl
+             << " headless:         Run without displaying or waiting until the target generation, or until" << endl
+             << "                   the board becomes still or periodic (at most 100000 generations), then" << endl
+             << "                   print a summary. Needs an input file." << endl
+             << " output:           Where the final board of a headless run is saved, format chosen by extension," << endl
+             << "                   or the counts of a census." << endl
+             << " render:           How the running board is drawn: 'cell' (default), 'half' (1*2 cells per character)" << endl
+             << "                   or 'braille' (2*4 cells per character). Boards larger than the terminal are cut." << endl
+             << " stopOnCycle:      Stop once the board becomes still or periodic (up to period 1024)." << endl
+             << " rule:             The Life-like rule in B/S notation, default is B3/S23. e.g. B36/S23 (HighLife)," << endl
+             << "                   B2/S (Seeds), B3678/S34678 (Day & Night). Overrides the rule saved in the input file." << endl
+             << " seed:             The seed of the first soup of a batch or a census, the next soups use the next seeds. Default is 1." << endl
+             << " size:             The board size of the soups of a batch as X*Y, default is 64*64." << endl
+             << " record:           Record every generation to a file (.golr) to be replayed later." << endl
+             << " checkpointEvery:  Save a checkpoint every this many generations, in the background." << endl
+             << " checkpointDir:    Where the checkpoints are saved, default is 'checkpoints' (or the resumed one)." << endl
+             << "                   The latest 2 are kept." << endl
+             << " stats:            Time the phases of each generation and count the cells, show the rates once a second" << endl
+             << "                   and save the totals to this file on exit, as JSON (.json) or CSV." << endl
+             << " trace:            Save every timed phase to this file on exit, in the Chrome trace format (JSON)." << endl;
         return 0;
     }
 
@@ -61,7 +336,13 @@ int main(int argc, char** argv)
         {
             try
             {
-                targetGeneration = stoul(arg.substr(19));
+                const unsigned long target = stoul(arg.substr(19));
+                if (target > INT_MAX)
+                {
+                    cout << "Target generation must be <= " << INT_MAX << endl;
+                    return 1;
+                }
+                targetGeneration = (int) target;
                 flInfiniteGenerations = false;
             }
             catch (...)
@@ -78,73 +359,678 @@ int main(int argc, char** argv)
             {
                 // use default: sleepMs = 500
             }
+        else if (arg.rfind("--fps=", 0) == 0)
+            try
+            {
+                fps = max(1, stoi(arg.substr(6)));
+            }
+            catch (...)
+            {
+                // use default: fps = 30
+            }
+        else if (arg.rfind("--threads=", 0) == 0)
+            try
+            {
+                threads = max(1, stoi(arg.substr(10)));
+            }
+            catch (...)
+            {
+                // use default: threads = 1
+            }
+        else if (arg.rfind("--processes=", 0) == 0)
+            try
+            {
+                processes = max(1, stoi(arg.substr(12)));
+            }
+            catch (...)
+            {
+                // use default: processes = 1
+            }
+        else if (arg.rfind("--historyMB=", 0) == 0)
+            try
+            {
+                historyMB = stoul(arg.substr(12));
+            }
+            catch (...)
+            {
+                // use default: historyMB = 64
+            }
+        else if (arg.rfind("--batch=", 0) == 0)
+            try
+            {
+                batchCount = max(1, stoi(arg.substr(8)));
+            }
+            catch (...)
+            {
+                cout << "Invalid batch size: " << arg.substr(8) << endl;
+                return 1;
+            }
+        else if (arg.rfind("--census=", 0) == 0)
+            try
+            {
+                censusCount = max(1, stoi(arg.substr(9)));
+            }
+            catch (...)
+            {
+                cout << "Invalid census size: " << arg.substr(9) << endl;
+                return 1;
+            }
+        else if (arg.rfind("--seed=", 0) == 0)
+            try
+            {
+                batchSeed = stoull(arg.substr(7));
+            }
+            catch (...)
+            {
+                // use default: batchSeed = 1
+            }
+        else if (arg.rfind("--size=", 0) == 0)
+        {
+            if (sscanf(arg.c_str() + 7, "%d*%d", &batchColumns, &batchLines) != 2 || batchColumns < 2 || batchLines < 2)
+            {
+                cout << "Invalid board size: " << arg.substr(7) << endl;
+                return 1;
+            }
+        }
+        else if (arg.rfind("--hashMB=", 0) == 0)
+            try
+            {
+                hashMB = stoul(arg.substr(9));
+            }
+            catch (...)
+            {
+                // use default: hashMB = 1024
+            }
         else if (arg == "--noBorder")
             flNoBorder = true;
         else if (arg == "--showBorder")
             flShowBorder = true;
+        else if (arg == "--unbounded")
+            flUnbounded = true;
+        else if (arg == "--headless")
+            flHeadless = true;
+        else if (arg == "--stopOnCycle")
+            flStopOnCycle = true;
+        else if (arg.rfind("--rule=", 0) == 0)
+        {
+            try
+            {
+                rule = Rule::parse(arg.substr(7));
+                flRule = true;
+            }
+            catch (exception& e)
+            {
+                cout << e.what() << endl;
+                return 1;
+            }
+        }
+        else if (arg.rfind("--output=", 0) == 0)
+            outputPath = arg.substr(9);
+        else if (arg.rfind("--resume=", 0) == 0)
+            resumePath = arg.substr(9);
+        else if (arg.rfind("--checkpointDir=", 0) == 0)
+            checkpointPath = arg.substr(16);
+        else if (arg.rfind("--checkpointEvery=", 0) == 0)
+            try
+            {
+                checkpointEvery = max(0, stoi(arg.substr(18)));
+            }
+            catch (...)
+            {
+                // use default: checkpointEvery = 0
+            }
+        else if (arg.rfind("--stats=", 0) == 0)
+            statsPath = arg.substr(8);
+        else if (arg.rfind("--trace=", 0) == 0)
+            tracePath = arg.substr(8);
+        else if (arg.rfind("--record=", 0) == 0)
+            recordPath = arg.substr(9);
+        else if (arg.rfind("--replay=", 0) == 0)
+            replayPath = arg.substr(9);
+        else if (arg.rfind("--render=", 0) == 0)
+        {
+            if (arg.substr(9) == "cell")
+                renderer.setMode(RENDER_CELL);
+            else if (arg.substr(9) == "half")
+                renderer.setMode(RENDER_HALF_BLOCK);
+            else if (arg.substr(9) == "braille")
+                renderer.setMode(RENDER_BRAILLE);
+            else
+            {
+                cout << "Unknown render mode: " << arg.substr(9) << endl;
+                return 1;
+            }
+        }
+        else if (arg.rfind("--kernel=", 0) == 0)
+        {
+            try
+            {
+                Kernel::select(arg.substr(9));
+            }
+            catch (exception& e)
+            {
+                cout << e.what() << endl;
+                return 1;
+            }
+        }
+        else if (arg.rfind("--engine=", 0) == 0)
+        {
+            if (arg.substr(9) == "bitpacked")
+                engineType = ENGINE_BITPACKED;
+            else if (arg.substr(9) == "hashlife")
+                engineType = ENGINE_HASHLIFE;
+            else if (arg.substr(9) == "sparse")
+                engineType = ENGINE_SPARSE;
+            else if (arg.substr(9) == "cell")
+                engineType = ENGINE_CELL;
+            else if (arg.substr(9) == "fixed")
+                engineType = ENGINE_FIXED;
+            else
+            {
+                cout << "Unknown engine: " << arg.substr(9) << endl;
+                return 1;
+            }
+        }
+
+#ifndef GOL_STATS
+    if (!statsPath.empty() || !tracePath.empty())
+    {
+        cout << "Stats are not supported by this build (GOL_STATS is off)" << endl;
+        return 1;
+    }
+#endif
+    if (flUnbounded && engineType != ENGINE_HASHLIFE)
+        engineType = ENGINE_SPARSE;
+    if (engineType == ENGINE_SPARSE && flNoBorder)
+    {
+        cout << "The unbounded universe does not have a border" << endl;
+        return 1;
+    }
+
+    if (rule.hasBirthOnZero() && (engineType == ENGINE_SPARSE || engineType == ENGINE_HASHLIFE))
+    {
+        cout << "B0 rules are not supported by the unbounded engines" << endl;
+        return 1;
+    }
+    if (batchCount != 0)
+    {
+        if (flInfiniteGenerations)
+        {
+            cout << "Batch mode needs the target generation" << endl;
+            return 1;
+        }
+        runBatch();
+        return 0;
+    }
+    if (censusCount != 0)
+    {
+        runCensus();
+        return 0;
+    }
+    if (!replayPath.empty())
+    {
+        renderer.setBorder(flShowBorder);
+        return runReplay();
+    }
+    string inputPath = args[0];
+    if (!resumePath.empty())
+    {
+        try
+        {
+            inputPath = Checkpointer::findLatest(resumePath);
+        }
+        catch (exception& e)
+        {
+            cout << e.what() << endl;
+            return 1;
+        }
+        bool dirGiven = false;
+        for (string& arg : args)
+            if (arg.rfind("--checkpointDir=", 0) == 0) dirGiven = true;
+        if (!dirGiven) checkpointPath = resumePath;
+    }
+    if (flHeadless && inputPath == "--new")
+    {
+        cout << "Headless mode needs an input file" << endl;
+        return 1;
+    }
 
     // initialize the engine
-    GoL& app = GoL::getInstance();
-    app.toggleNoBorder(flNoBorder);
-    if (args[0] == "--new") // create new board
+    renderer.setBorder(flShowBorder);
+    if (flHeadless) app.setVerbose(false); // only the summary goes to the standard output
+    app.setEngine(engineType).setThreads(threads).setHistoryLimit(historyMB << 20).setHashLifeLimit(hashMB << 20).toggleNoBorder(flNoBorder);
+    try
+    {
+        app.setProcesses(processes);
+    }
+    catch (exception& e)
+    {
+        cout << e.what() << endl;
+        return 1;
+    }
+    // a headless run only needs the hashes to stop early
+    app.setCycleDetection(!flHeadless || flStopOnCycle || flInfiniteGenerations);
+    if (flRule) app.setRule(rule);
+    if (flHeadless)
+    {
+        app.setHistoryLimit(0); // nothing to undo
+        app.init(inputPath);
+        if (flRule) app.setRule(rule);
+        if (!startPersisting()) return 1;
+        startStats();
+        runHeadless();
+        app.setCheckpoints(checkpointPath, 0); // wait for the last checkpoint
+        app.stopRecording();
+        writeStats();
+        return 0;
+    }
+    if (inputPath == "--new") // create new board
     {
         int lines = 0, columns = 0;
         cout << "Enter: Size (X Y)" << endl << "? ";
         cout.flush();
         cin >> columns >> lines;
         app.init(lines, columns);
-        showMenu(0);
+        showMenu();
     }
     else // load the board from local file
     {
         // pass the file path to the GoL simulator
-        app.init(args[0]);
+        app.init(inputPath);
+        if (flRule) app.setRule(rule);
         // display initial state if target generation is not specified
-        if (flInfiniteGenerations) showMenu(0);
+        if (flInfiniteGenerations) showMenu();
     }
 
-    signal(SIGINT, showMenu); // register for Ctrl+C event
+    if (!startPersisting()) return 1;
+    startStats();
+    signal(SIGINT, interrupt); // register for Ctrl+C event
     mainLoop();
+    app.setCheckpoints(checkpointPath, 0);
+    app.stopRecording();
+    writeStats();
 
     return 0;
 }
 
-void mainLoop()
+void runHeadless()
 {
-    GoL& app = GoL::getInstance();
-    while (flInfiniteGenerations || app.getCurrentGeneration() != targetGeneration)
+    const int start = app.getCurrentGeneration();
+    const auto begin = chrono::steady_clock::now();
+    if (!flInfiniteGenerations && !flStopOnCycle)
     {
-        if (flPause)
+        if (app.getStats() && !app.canJump())
         {
-            CommonUtil::freeze(500);
-            continue;
+            // the same as forward(), but the stats are shown on the way
+            while (app.getCurrentGeneration() < targetGeneration)
+            {
+                app.run();
+                if (updateStats()) cerr << statsText << endl;
+            }
         }
-        CommonUtil::clearScreen();
-        app.run().display(flShowBorder); // iterate once and display the new state
-        cout << "Current generation: " << app.getCurrentGeneration()
-             << ". Board size: " << app.getColumns() << "*" << app.getLines() << endl
-             << "[Ctrl+C]Pause" << endl;
+        else if (app.getCurrentGeneration() < targetGeneration)
+            try
+            {
+                app.forward(targetGeneration - app.getCurrentGeneration());
+            }
+            catch (exception& e)
+            {
+                cerr << e.what() << endl; // the summary shows how far it got
+            }
+    }
+    else
+    {
+        // without a target, run until the board becomes still or periodic, boards which never repeat up to a limit
+        const int limit = flInfiniteGenerations ? start + HEADLESS_LIMIT : targetGeneration;
+        while (app.getCurrentGeneration() < limit && app.getPeriod() == 0)
+        {
+            app.run();
+            if (updateStats()) cerr << statsText << endl;
+        }
+        if (flInfiniteGenerations && app.getPeriod() == 0)
+            cerr << "No cycle found within " << HEADLESS_LIMIT << " generations" << endl;
+    }
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    if (!outputPath.empty())
+        try
+        {
+            app.save(outputPath);
+        }
+        catch (exception& e)
+        {
+            cerr << e.what() << endl;
+        }
+    const long generations = app.getCurrentGeneration() - start;
+    const double cells = (double) app.getLines() * app.getColumns() * generations;
+    cout << "generations=" << generations
+         << " seconds=" << seconds
+         << " gens_per_sec=" << (seconds > 0 ? generations / seconds : 0)
+         << " cells_per_sec=" << (seconds > 0 ? cells / seconds : 0)
+         << " population=" << app.getPopulation()
+         << " rule=" << app.getRule().toString()
+         << " stable=" << (app.getPeriod() == 1 ? 1 : 0)
+         << " period=" << app.getPeriod()
+         << " cycle_start=" << app.getCycleStart() << endl;
+}
+
+void runBatch()
+{
+    BatchRunner runner;
+    runner.setEngine(engineType).setRule(rule).toggleNoBorder(flNoBorder).setStopOnCycle(flStopOnCycle)
+            .setThreads(threads).setTargetGeneration(targetGeneration).setHashLifeLimit(hashMB << 20);
+    const auto begin = chrono::steady_clock::now();
+    vector<BatchResult> results;
+    try
+    {
+        results = runner.run(batchCount, [](const int& i, BitBoard& board) {
+            board = BatchRunner::soup(batchSeed + i, batchLines, batchColumns);
+        });
+    }
+    catch (exception& e)
+    {
+        cout << e.what() << endl;
+        return;
+    }
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    stringstream out;
+    long generations = 0;
+    for (size_t i = 0; i != results.size(); ++i)
+    {
+        const BatchResult& result = results[i];
+        generations += result.generations;
+        out << "seed=" << batchSeed + i
+            << " generations=" << result.generations
+            << " population=" << result.population
+            << " period=" << result.period
+            << " cycle_start=" << result.cycleStart << '\n';
+    }
+    out << "boards=" << results.size()
+        << " seconds=" << seconds
+        << " boards_per_sec=" << (seconds > 0 ? results.size() / seconds : 0)
+        << " gens_per_sec=" << (seconds > 0 ? generations / seconds : 0) << '\n';
+    cout << out.str();
+    cout.flush();
+}
+
+void runCensus()
+{
+    Census census;
+    const auto begin = chrono::steady_clock::now();
+    auto saved = begin;
+    mutex savedMutex;
+    try
+    {
+        census.setRule(rule).setThreads(threads);
+        if (!flInfiniteGenerations) census.setMaxGenerations(targetGeneration);
+        census.run(batchSeed, censusCount, [&]() {
+            unique_lock<mutex> lock(savedMutex, try_to_lock);
+            const auto now = chrono::steady_clock::now();
+            if (!lock || now - saved < chrono::seconds(1)) return;
+            saved = now;
+            const double seconds = chrono::duration<double>(now - begin).count();
+            cerr << "Census: " << census.getSoups() << "/" << censusCount << " soups, "
+                 << census.getSoups() / seconds << " soups/s" << endl;
+            if (!outputPath.empty()) census.write(outputPath);
+        });
+        if (!outputPath.empty()) census.write(outputPath);
+    }
+    catch (exception& e)
+    {
+        cout << e.what() << endl;
+        return;
+    }
+    const double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    const vector<CensusObject> objects = census.getObjects();
+    stringstream out;
+    if (outputPath.empty())
+        for (const CensusObject& object : objects)
+        {
+            string name = object.name.empty() ? "-" : object.name;
+            replace(name.begin(), name.end(), ' ', '_');
+            out << "code=" << object.code
+                << " name=" << name
+                << " period=" << object.period
+                << " population=" << object.population
+                << " count=" << object.count << '\n';
+        }
+    const double soupsPerSecond = seconds > 0 ? census.getSoups() / seconds : 0;
+    out << "soups=" << census.getSoups()
+        << " unstabilized=" << census.getUnstabilized()
+        << " objects=" << objects.size()
+        << " seconds=" << seconds
+        << " soups_per_sec=" << soupsPerSecond
+        << " soups_per_sec_per_thread=" << soupsPerSecond / threads << '\n';
+    cout << out.str();
+    cout.flush();
+}
+
+int runReplay()
+{
+    try
+    {
+        RecordReader reader(replayPath);
+        if (reader.size() == 0)
+        {
+            cout << "The recording is empty" << endl;
+            return 1;
+        }
+        size_t frame = 0;
+        if (!flInfiniteGenerations)
+        {
+            const long found = reader.find(targetGeneration);
+            if (found < 0)
+            {
+                cout << "Generation " << targetGeneration << " was not recorded" << endl;
+                return 1;
+            }
+            frame = (size_t) found;
+        }
+        BitBoard board;
+        reader.seek(frame, board);
+
+        if (flHeadless)
+        {
+            if (!outputPath.empty())
+                app.setVerbose(false).setHistoryLimit(0).setRule(reader.getRule()).init(board).save(outputPath);
+            cout << "generation=" << reader.getGeneration(frame)
+                 << " frame=" << frame
+                 << " frames=" << reader.size()
+                 << " population=" << board.population() << endl;
+            return 0;
+        }
+
+        signal(SIGINT, interrupt);
+        for (;;)
+        {
+            stringstream text;
+            text << "Replaying generation " << reader.getGeneration(frame) << " (frame " << frame + 1 << "/" << reader.size()
+                 << "). Board size: " << board.getColumns() << "*" << board.getLines() << viewStatus() << "\n[Ctrl+C]Pause";
+            renderer.render(board, text.str());
+            if (interrupted || frame + 1 == reader.size())
+            {
+                interrupted = false;
+                if (frame + 1 == reader.size()) cout << "End of recording" << endl;
+                if (!showReplayMenu(reader, frame, board)) return 0;
+                continue;
+            }
+            CommonUtil::freeze(sleepMs);
+            reader.seek(++frame, board);
+        }
+    }
+    catch (exception& e)
+    {
+        cout << e.what() << endl;
+        return 1;
+    }
+}
+
+bool showReplayMenu(RecordReader& reader, size_t& frame, BitBoard& board)
+{
+    for (;;)
+    {
+        cout << "[Q]Exit [W]Start/Resume [T]Goto [V]View" << endl << "? ";
         flush(cout);
-        CommonUtil::freeze(sleepMs); // wait a few moment to avoid the program from running too fast
+        string s;
+        cin >> s;
+        if (!cin || s == "q" || s == "Q")
+            return false;
+        else if (s == "w" || s == "W")
+        {
+            if (frame + 1 != reader.size()) break;
+        }
+        else if (s == "t" || s == "T")
+        {
+            cout << "Enter: Target generation" << endl << "? ";
+            flush(cout);
+            int g;
+            if (cin >> g)
+            {
+                const long found = reader.find(g);
+                if (found >= 0)
+                {
+                    frame = (size_t) found;
+                    reader.seek(frame, board);
+                    break;
+                }
+                cout << "Generation " << g << " was not recorded" << endl;
+            }
+        }
+        else if (s == "v" || s == "V")
+        {
+            cout << "Enter: Zoom(1=cell, 2=half block, 4=braille) X Y (the top-left cell)" << endl << "? ";
+            flush(cout);
+            int zoom, x, y;
+            if (cin >> zoom >> x >> y && (zoom == RENDER_CELL || zoom == RENDER_HALF_BLOCK || zoom == RENDER_BRAILLE))
+            {
+                renderer.setMode((RenderMode) zoom).setView(y - 1, x - 1);
+                break;
+            }
+        }
+        resetStdin(); // invalid input, ask again
+    }
+    resetStdin();
+    renderer.invalidate();
+    return true;
+}
+
+void mainLoop()
+{
+    if (!flInfiniteGenerations && app.canJump() && app.getCurrentGeneration() < targetGeneration)
+    {
+        // no need to watch every generation, jump to the target at once
+        cout << "Please wait" << endl;
+        try
+        {
+            app.forward(targetGeneration - app.getCurrentGeneration());
+        }
+        catch (exception& e)
+        {
+            cout << e.what() << endl; // go on in this process
+            app.setProcesses(1);
+        }
+        renderer.invalidate();
+        render("");
+    }
+    while (!finished())
+    {
+        interrupted = false;
+        stopping = false;
+        simulating = true;
+        frames.acquire(); // drop the frame left by the last run
+        thread simulation(simulate), rendering(draw);
+        while (simulating && !interrupted)
+            CommonUtil::freeze(10);
+        {
+            lock_guard<mutex> lock(sessionMutex);
+            stopping = true;
+        }
+        sessionWake.notify_all();
+        simulation.join();
+        rendering.join();
+        if (finished()) break;
+        showMenu(); // the threads are stopped, the board can be used freely
     }
-    cout << "Target generation reached" << endl;
+    render(""); // the render thread may have dropped the last frame
+    if (flStopOnCycle && app.getPeriod() != 0)
+    {
+        cout << endl << "Cycle reached" << endl;
+        return;
+    }
+    cout << endl << "Target generation reached" << endl;
+}
+
+void simulate()
+{
+    unique_lock<mutex> lock(sessionMutex, defer_lock);
+    while (!finished())
+    {
+        app.run();
+        updateStats();
+        if (frameWanted.exchange(false))
+        {
+            // copy the board only when the render thread can draw it
+            GOL_PHASE(app.getStats(), PHASE_FRAME);
+            Frame& next = frames.getBack();
+            app.store(next.board);
+            long activeTiles, totalTiles;
+            app.getTileStats(activeTiles, totalTiles);
+            stringstream text;
+            text << status();
+            if (totalTiles != 0)
+                text << ". Active tiles: " << activeTiles << "/" << totalTiles;
+            if (!statsText.empty())
+                text << '\n' << statsText;
+            next.status = text.str();
+            frames.publish();
+        }
+        lock.lock();
+        // wait a few moment to avoid the program from running too fast
+        if (sleepMs != 0) sessionWake.wait_for(lock, chrono::milliseconds(sleepMs), [] { return stopping; });
+        const bool stop = stopping;
+        lock.unlock();
+        if (stop) break;
+    }
+    simulating = false;
 }
 
-void showMenu(int)
+void draw()
 {
-    flPause = true;
-    GoL& app = GoL::getInstance();
+    const auto interval = chrono::microseconds(1000000 / fps);
+    unique_lock<mutex> lock(sessionMutex);
+    while (!stopping)
+    {
+        lock.unlock();
+        frameWanted = true;
+        if (frames.acquire())
+        {
+            GOL_PHASE(app.getStats(), PHASE_RENDER);
+            renderer.render(frames.getFront().board, frames.getFront().status + viewStatus() + "\n[Ctrl+C]Pause");
+        }
+        lock.lock();
+        sessionWake.wait_for(lock, interval, [] { return stopping; });
+    }
+}
 
+void showMenu()
+{
+    string message; // shown once after the board, e.g. why exporting failed
     for (;;)
     {
         // display current state
         CommonUtil::clearScreen();
         app.display(flShowBorder);
-        cout << "Current generation: " << app.getCurrentGeneration()
-             << ". Board size: " << app.getColumns() << "*" << app.getLines() << endl;
+        cout << status() << endl;
+        if (!message.empty())
+        {
+            cout << message << endl;
+            message.clear();
+        }
 
         // ask for option
-        cout << "[Q]Exit [W]Start/Resume [E]Edit [R]Revert [T]Goto [Y]Export" << endl << "? ";
+        cout << "[Q]Exit [W]Start/Resume [E]Edit [R]Revert [T]Goto [Y]Export [V]View [S]Stamp [F]Fill [C]Copy" << endl << "? ";
         flush(cout);
         string s;
         cin >> s;
@@ -152,6 +1038,9 @@ void showMenu(int)
         if (s == "q" || s == "Q") // exit
         {
             cout << "Exiting" << endl;
+            app.setCheckpoints(checkpointPath, 0);
+            app.stopRecording();
+            writeStats();
             exit(0);
         }
         else if (s == "w" || s == "W") // resume
@@ -164,9 +1053,61 @@ void showMenu(int)
             flush(cout);
             int x, y;
             char state;
-            if (cin >> x >> y >> state && x > 0 && x <= app.getColumns() && y > 0 && y <= app.getLines())
+            if (cin >> x >> y >> state
+                && (app.isUnbounded() || (x > 0 && x <= app.getColumns() && y > 0 && y <= app.getLines())))
                 app.setStateOf(y, x, CommonUtil::parseCellState(state));
         }
+        else if (s == "s" || s == "S") // stamp a pattern file
+        {
+            cout << "Enter: File path X Y Symmetry(0-3=rotate by 90 degrees clockwise that many times," << endl
+                 << "       4-7=flip left to right, then the same)" << endl << "? ";
+            flush(cout);
+            string path;
+            int x, y, symmetry;
+            if (cin >> path >> x >> y >> symmetry)
+                try
+                {
+                    app.stamp(path, y, x, symmetry);
+                }
+                catch (exception& e)
+                {
+                    message = e.what();
+                }
+        }
+        else if (s == "f" || s == "F") // fill, clear or randomize a rectangle
+        {
+            cout << "Enter: X Y Width Height Density(0=clear, 1=fill, in between=random)" << endl << "? ";
+            flush(cout);
+            int x, y, width, height;
+            double density;
+            if (cin >> x >> y >> width >> height >> density)
+                try
+                {
+                    if (density <= 0 || density >= 1)
+                        app.fill(y, x, height, width, density >= 1 ? STATE_ALIVE : STATE_DEAD);
+                    else
+                        app.randomize(y, x, height, width, density, random_device()());
+                }
+                catch (exception& e)
+                {
+                    message = e.what();
+                }
+        }
+        else if (s == "c" || s == "C") // copy or move a rectangle
+        {
+            cout << "Enter: X Y Width Height ToX ToY Move(0=copy, 1=move)" << endl << "? ";
+            flush(cout);
+            int x, y, width, height, toX, toY, move;
+            if (cin >> x >> y >> width >> height >> toX >> toY >> move)
+                try
+                {
+                    app.copy(y, x, height, width, toY, toX, move != 0);
+                }
+                catch (exception& e)
+                {
+                    message = e.what();
+                }
+        }
         else if (s == "r" || s == "R") // revert
         {
             app.revert(1);
@@ -181,25 +1122,47 @@ void showMenu(int)
                 if (g == app.getCurrentGeneration()) continue;
                 cout << "Please wait";
                 flush(cout);
-                if (g > app.getCurrentGeneration())
-                    app.forward(g - app.getCurrentGeneration());
-                else
-                    app.revert(app.getCurrentGeneration() - g);
+                try
+                {
+                    if (g > app.getCurrentGeneration())
+                        app.forward(g - app.getCurrentGeneration());
+                    else
+                        app.revert(app.getCurrentGeneration() - g);
+                }
+                catch (exception& e)
+                {
+                    message = e.what();
+                }
             }
         }
         else if (s == "y" || s == "Y") // export
         {
-            cout << "Enter: File path" << endl << "? ";
+            cout << "Enter: File path (*.golb, *.rle, *.cells or text)" << endl << "? ";
             flush(cout);
             string path;
             cin >> path;
-            if (!path.empty()) app.save(path);
+            if (!path.empty())
+                try
+                {
+                    app.save(path);
+                }
+                catch (exception& e)
+                {
+                    message = e.what();
+                }
+        }
+        else if (s == "v" || s == "V") // move or zoom the viewport of the running board
+        {
+            cout << "Enter: Zoom(1=cell, 2=half block, 4=braille) X Y (the top-left cell)" << endl << "? ";
+            flush(cout);
+            int zoom, x, y;
+            if (cin >> zoom >> x >> y && (zoom == RENDER_CELL || zoom == RENDER_HALF_BLOCK || zoom == RENDER_BRAILLE))
+                renderer.setMode((RenderMode) zoom).setView(y - 1, x - 1);
         }
         resetStdin(); // invalid input, ask again
     }
     resetStdin();
 
     // resume
-    signal(SIGINT, showMenu); // why re-register? cuz windows sucks
-    flPause = false;
+    renderer.invalidate();
 }
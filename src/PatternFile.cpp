@@ -0,0 +1,291 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include "PatternFile.h"
+
+using namespace std;
+
+namespace
+{
+    const int EOF_CHAR = char_traits<char>::eof();
+    const int RLE_WIDTH = 70; // the maximum length of a line in RLE files
+
+    bool hasExtension(const string& path, const string& extension)
+    {
+        return path.size() >= extension.size()
+               && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+    }
+
+    void openFailed(const string& path)
+    {
+        throw runtime_error(string("Unable to read input file: ").append(path));
+    }
+
+    /**
+     * Sets the cells in [begin, end) of a line alive, a word at a time.
+     */
+    void fill(BitBoard& board, const int& line, const int& begin, const int& end)
+    {
+        uint64_t* l = board.line(line);
+        for (int j = begin; j < end;)
+        {
+            const int bit = j % 64, count = min(64 - bit, end - j);
+            l[j / 64] |= (count == 64 ? ~0ULL : ((1ULL << count) - 1)) << bit;
+            j += count;
+        }
+    }
+
+    /**
+     * Finds the first column from a column whose state is not the given one.
+     * @return The columns of the board if there is none.
+     */
+    int skip(const BitBoard& board, const int& line, const int& from, const bool& alive)
+    {
+        const uint64_t* l = board.line(line);
+        const int columns = board.getColumns();
+        for (int w = from / 64; w * 64 < columns; ++w)
+        {
+            uint64_t bits = alive ? ~l[w] : l[w];
+            if (w == from / 64) bits &= ~0ULL << (from % 64);
+            if (bits) return min(columns, w * 64 + __builtin_ctzll(bits));
+        }
+        return columns;
+    }
+
+    /**
+     * Writes RLE items, starting a new line before an item would pass the width limit.
+     */
+    class RleWriter
+    {
+    private:
+        ostream& out;
+        int width = 0;
+    public:
+        explicit RleWriter(ostream& out) : out(out)
+        {
+        }
+
+        void put(const long& count, const char& tag)
+        {
+            if (count < 1) return;
+            char item[24];
+            const int length = count == 1 ? snprintf(item, sizeof(item), "%c", tag)
+                                          : snprintf(item, sizeof(item), "%ld%c", count, tag);
+            if (width + length > RLE_WIDTH)
+            {
+                out << '\n';
+                width = 0;
+            }
+            out.write(item, length);
+            width += length;
+        }
+    };
+}
+
+bool PatternFile::isRle(const string& path)
+{
+    return hasExtension(path, ".rle");
+}
+
+bool PatternFile::isCells(const string& path)
+{
+    return hasExtension(path, ".cells");
+}
+
+void PatternFile::readRle(const string& path, BitBoard& board, Rule& rule)
+{
+    ifstream in(path);
+    if (!in) openFailed(path);
+    streambuf* buf = in.rdbuf();
+
+    // skip the comments, then read the header line "x = m, y = n, rule = abc"
+    int c = buf->sbumpc();
+    while (c == '#' || c == '\n' || c == '\r')
+    {
+        while (c != '\n' && c != EOF_CHAR) c = buf->sbumpc();
+        c = buf->sbumpc();
+    }
+    long columns = -1, lines = -1;
+    while (c != '\n' && c != EOF_CHAR)
+    {
+        if (c == 'x' || c == 'y')
+        {
+            const int key = c;
+            while ((c = buf->sbumpc()) == ' ' || c == '=');
+            long value = 0;
+            for (; c >= '0' && c <= '9'; c = buf->sbumpc())
+                value = value * 10 + (c - '0');
+            (key == 'x' ? columns : lines) = value;
+            continue;
+        }
+        if (c == 'r') // the rule is the last item
+        {
+            while (c != '=' && c != '\n' && c != EOF_CHAR) c = buf->sbumpc();
+            string text;
+            for (c = buf->sbumpc(); c != '\n' && c != EOF_CHAR; c = buf->sbumpc())
+                if (c != ' ' && c != '\r') text += (char) c;
+            if (!text.empty()) rule = Rule::parse(text);
+        }
+        else
+            c = buf->sbumpc();
+    }
+    if (columns < 0 || lines < 0 || columns > INT32_MAX || lines > INT32_MAX)
+        throw runtime_error(string("Missing RLE header in ").append(path));
+    board = BitBoard((int) lines, (int) columns);
+
+    // read the runs: <count>b for dead cells, <count>o for live cells, <count>$ for line ends, ! to stop
+    long line = 0, column = 0, count = 0;
+    while ((c = buf->sbumpc()) != EOF_CHAR && c != '!')
+    {
+        if (c >= '0' && c <= '9')
+        {
+            count = count * 10 + (c - '0');
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') continue;
+        const long n = count ? count : 1;
+        count = 0;
+        if (c == '$')
+        {
+            line += n;
+            column = 0;
+            continue;
+        }
+        if (column + n > columns || line >= lines)
+        {
+            stringstream msg;
+            msg << "Pattern exceeds its size " << columns << "*" << lines << " at line " << line + 1;
+            throw runtime_error(msg.str());
+        }
+        if (c != 'b' && c != '.') // any other state is alive
+            fill(board, (int) line, (int) column, (int) (column + n));
+        column += n;
+    }
+    in.close();
+}
+
+void PatternFile::readCells(const string& path, BitBoard& board)
+{
+    ifstream in(path);
+    if (!in) openFailed(path);
+    streambuf* buf = in.rdbuf();
+
+    // measure: the lines and the longest line, comments excluded
+    int lines = 0, columns = 0, length = 0, c;
+    bool comment = false, empty = true;
+    while ((c = buf->sbumpc()) != EOF_CHAR)
+    {
+        if (c == '\n')
+        {
+            if (!comment) ++lines;
+            comment = false;
+            empty = true;
+            length = 0;
+            continue;
+        }
+        if (empty && c == '!') comment = true;
+        empty = false;
+        if (comment || c == '\r') continue;
+        if (c != '.' && c != 'O' && c != '*')
+        {
+            stringstream msg;
+            msg << "Unexpected character '" << (char) c << "' at line " << lines + 1;
+            throw runtime_error(msg.str());
+        }
+        columns = max(columns, ++length);
+    }
+    if (!empty && !comment) ++lines;
+    board = BitBoard(lines, columns);
+
+    // set the cells
+    in.clear();
+    in.seekg(0);
+    int line = 0, column = 0;
+    comment = false;
+    empty = true;
+    while ((c = buf->sbumpc()) != EOF_CHAR)
+    {
+        if (c == '\n')
+        {
+            if (!comment) ++line;
+            comment = false;
+            empty = true;
+            column = 0;
+            continue;
+        }
+        if (empty && c == '!') comment = true;
+        empty = false;
+        if (comment || c == '\r') continue;
+        if (c != '.') board.set(line, column, true);
+        ++column;
+    }
+    in.close();
+}
+
+bool PatternFile::writeRle(const string& path, const BitBoard& board, const Rule& rule)
+{
+    ofstream out(path);
+    if (!out) return false;
+    out << "x = " << board.getColumns() << ", y = " << board.getLines() << ", rule = " << rule.toString() << "\n";
+
+    RleWriter writer(out);
+    long pendingLines = 0; // the line ends not written yet, merged into one item
+    for (int i = 0; i != board.getLines(); ++i)
+    {
+        int j = skip(board, i, 0, false);
+        if (j != board.getColumns())
+        {
+            writer.put(pendingLines, '$');
+            pendingLines = 0;
+        }
+        int from = 0;
+        while (j != board.getColumns())
+        {
+            const int end = skip(board, i, j, true);
+            writer.put(j - from, 'b');
+            writer.put(end - j, 'o');
+            from = end;
+            j = skip(board, i, end, false);
+        }
+        ++pendingLines;
+    }
+    writer.put(1, '!');
+    out << '\n';
+    out.close();
+    return !out.fail();
+}
+
+bool PatternFile::writeCells(const string& path, const BitBoard& board)
+{
+    ofstream out(path);
+    if (!out) return false;
+    const size_t slash = path.find_last_of("/\\");
+    string name = path.substr(slash == string::npos ? 0 : slash + 1);
+    out << "!Name: " << name.substr(0, name.size() - 6) << '\n';
+
+    streambuf* buf = out.rdbuf();
+    for (int i = 0; i != board.getLines(); ++i)
+    {
+        // find the last live cell of the line
+        const uint64_t* l = board.line(i);
+        int end = 0;
+        for (int w = board.getWordsPerLine() - 1; w >= 0; --w)
+            if (l[w])
+            {
+                end = w * 64 + 64 - __builtin_clzll(l[w]);
+                break;
+            }
+        for (int j = 0; j != end; ++j)
+            buf->sputc(board.get(i, j) ? 'O' : '.');
+        buf->sputc('\n');
+    }
+    out.close();
+    return !out.fail();
+}
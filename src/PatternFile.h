@@ -0,0 +1,55 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_PATTERNFILE_H
+#define GOL_PATTERNFILE_H
+
+#include <string>
+#include "BitBoard.h"
+#include "Rule.h"
+
+/**
+ * Reads and writes the standard pattern formats: run length encoded (.rle)
+ * and plaintext (.cells). The files are streamed character by character,
+ * so the memory used is the board itself no matter how large the file is.
+ * <br>
+ * The rule is kept in the header of RLE files. Plaintext files have no
+ * place for it.
+ */
+class PatternFile
+{
+public:
+    static bool isRle(const std::string& path);
+
+    static bool isCells(const std::string& path);
+
+    /**
+     * Loads an RLE pattern, the board is sized by the x and y in its header.
+     * @param rule Receives the rule in the header, unchanged if there is none.
+     * @throws std::runtime_error if the file can not be read, has no header,
+     * has a malformed rule or has cells outside the size in the header.
+     */
+    static void readRle(const std::string& path, BitBoard& board, Rule& rule);
+
+    /**
+     * Loads a plaintext pattern. The file is read twice, once to measure the
+     * pattern and once to set the cells.
+     * @throws std::runtime_error if the file can not be read or has an unexpected character.
+     */
+    static void readCells(const std::string& path, BitBoard& board);
+
+    /**
+     * Saves a board as RLE, lines wrapped at 70 characters.
+     * @return false if the file can not be written.
+     */
+    static bool writeRle(const std::string& path, const BitBoard& board, const Rule& rule);
+
+    /**
+     * Saves a board as plaintext, the dead cells at the end of the lines are omitted.
+     * @return false if the file can not be written.
+     */
+    static bool writeCells(const std::string& path, const BitBoard& board);
+};
+
+#endif //GOL_PATTERNFILE_H
@@ -0,0 +1,294 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <cstring>
+#include <stdexcept>
+#include "RecordFile.h"
+#include "History.h"
+
+using namespace std;
+
+namespace
+{
+    const char MAGIC[4] = {'G', 'O', 'L', 'R'};
+    const char INDEX_MAGIC[4] = {'G', 'O', 'L', 'I'};
+    const uint32_t VERSION = 1;
+    const uint64_t KEYFRAME = 1ULL << 63; // in the offsets of the index
+
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint16_t birth, survival;
+        uint32_t reserved;
+    };
+
+    struct FrameHeader
+    {
+        int32_t generation;
+        uint32_t keyframe;
+        int32_t lines, columns;
+        int32_t originLine, originColumn;
+        uint32_t runs; // (first word, word count) pairs, 0 for keyframes
+        uint32_t words; // following the runs
+    };
+
+    struct Trailer
+    {
+        uint64_t indexOffset; // the offsets of the frames, then their generations
+        uint64_t frames;
+        char magic[4];
+        uint32_t version;
+    };
+}
+
+const size_t RecordWriter::CHUNK_BYTES;
+
+RecordWriter::RecordWriter(const string& path, const Rule& rule)
+{
+    out.open(path, ios::binary | ios::trunc);
+    if (!out) throw runtime_error(string("Unable to write record file: ").append(path));
+
+    Header header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.birth = rule.getBirth();
+    header.survival = rule.getSurvival();
+    out.write((const char*) &header, sizeof(header));
+    offset = sizeof(header);
+    chunk.reserve(CHUNK_BYTES);
+    writing.reserve(CHUNK_BYTES);
+    writer = thread(&RecordWriter::work, this);
+}
+
+RecordWriter::~RecordWriter()
+{
+    close();
+}
+
+BitBoard& RecordWriter::getNext()
+{
+    return next;
+}
+
+void RecordWriter::append(const void* data, const size_t& bytes)
+{
+    chunk.insert(chunk.end(), (const char*) data, (const char*) data + bytes);
+}
+
+void RecordWriter::commit(const int& generation)
+{
+    const size_t boardBytes = next.getWords().size() * sizeof(uint64_t);
+    bool keyframe = offsets.empty() || !next.sameSizeAs(previous) || runsSinceKeyframe >= boardBytes;
+    if (!keyframe)
+    {
+        History::diff(previous, next, runs, bits);
+        keyframe = runs.size() * sizeof(uint32_t) + bits.size() * sizeof(uint64_t) >= boardBytes;
+    }
+
+    FrameHeader header = {};
+    header.generation = generation;
+    header.keyframe = keyframe;
+    header.lines = next.getLines();
+    header.columns = next.getColumns();
+    header.originLine = next.getOriginLine();
+    header.originColumn = next.getOriginColumn();
+    header.runs = keyframe ? 0 : (uint32_t) (runs.size() / 2);
+    header.words = (uint32_t) (keyframe ? next.getWords().size() : bits.size());
+    append(&header, sizeof(header));
+    size_t bytes = sizeof(header);
+    if (keyframe)
+    {
+        append(next.getWords().data(), boardBytes);
+        bytes += boardBytes;
+        runsSinceKeyframe = 0;
+    }
+    else
+    {
+        append(runs.data(), runs.size() * sizeof(uint32_t));
+        append(bits.data(), bits.size() * sizeof(uint64_t));
+        bytes += runs.size() * sizeof(uint32_t) + bits.size() * sizeof(uint64_t);
+        runsSinceKeyframe += bytes;
+    }
+
+    offsets.push_back(offset | (keyframe ? KEYFRAME : 0));
+    generations.push_back(generation);
+    offset += bytes;
+    swap(previous, next);
+    if (chunk.size() >= CHUNK_BYTES) flush();
+}
+
+void RecordWriter::flush()
+{
+    unique_lock<std::mutex> lock(mutex);
+    written.wait(lock, [this] { return writing.empty(); });
+    swap(chunk, writing);
+    ready.notify_one();
+}
+
+void RecordWriter::work()
+{
+    unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        ready.wait(lock, [this] { return closing || !writing.empty(); });
+        if (writing.empty()) return; // closing
+        lock.unlock();
+        out.write(writing.data(), (streamsize) writing.size());
+        lock.lock();
+        if (!out) failed = true;
+        writing.clear();
+        written.notify_one();
+    }
+}
+
+bool RecordWriter::close()
+{
+    if (!writer.joinable()) return !failed;
+    flush();
+    {
+        lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    ready.notify_one();
+    writer.join();
+
+    Trailer trailer = {};
+    trailer.indexOffset = offset;
+    trailer.frames = offsets.size();
+    memcpy(trailer.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    trailer.version = VERSION;
+    out.write((const char*) offsets.data(), (streamsize) (offsets.size() * sizeof(uint64_t)));
+    out.write((const char*) generations.data(), (streamsize) (generations.size() * sizeof(int32_t)));
+    out.write((const char*) &trailer, sizeof(trailer));
+    out.close();
+    if (out.fail()) failed = true;
+    return !failed;
+}
+
+RecordReader::RecordReader(const string& path) : path(path)
+{
+    in.open(path, ios::binary);
+    if (!in) throw runtime_error(string("Unable to read record file: ").append(path));
+    Header header = {};
+    if (!in.read((char*) &header, sizeof(header)) || memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+        throw runtime_error(string("Not a record file: ").append(path));
+    if (header.version != VERSION)
+        throw runtime_error(string("Unsupported record version ").append(to_string(header.version)));
+    rule = Rule(header.birth, header.survival);
+
+    in.seekg(0, ios::end);
+    const uint64_t length = (uint64_t) in.tellg();
+    Trailer trailer = {};
+    if (length >= sizeof(Header) + sizeof(Trailer))
+    {
+        in.seekg((streamoff) (length - sizeof(Trailer)));
+        in.read((char*) &trailer, sizeof(trailer));
+    }
+    const uint64_t indexBytes = trailer.frames * (sizeof(uint64_t) + sizeof(int32_t)) + sizeof(Trailer);
+    if (!in || memcmp(trailer.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0
+        || trailer.indexOffset + indexBytes != length)
+    {
+        // not closed, e.g. the run was killed
+        in.clear();
+        scan(length);
+        return;
+    }
+
+    vector<uint64_t> offsets(trailer.frames);
+    vector<int32_t> generations(trailer.frames);
+    in.seekg((streamoff) trailer.indexOffset);
+    in.read((char*) offsets.data(), (streamsize) (offsets.size() * sizeof(uint64_t)));
+    in.read((char*) generations.data(), (streamsize) (generations.size() * sizeof(int32_t)));
+    if (!in) throw runtime_error(string("Corrupted record file: ").append(path));
+    frames.reserve(offsets.size());
+    for (size_t i = 0; i != offsets.size(); ++i)
+        frames.push_back({generations[i], (offsets[i] & KEYFRAME) != 0, offsets[i] & ~KEYFRAME});
+}
+
+void RecordReader::scan(const uint64_t& end)
+{
+    uint64_t position = sizeof(Header);
+    FrameHeader header = {};
+    in.seekg((streamoff) position);
+    while (position + sizeof(header) <= end && in.read((char*) &header, sizeof(header)))
+    {
+        const uint64_t bytes = sizeof(header) + (uint64_t) header.runs * 2 * sizeof(uint32_t)
+                               + (uint64_t) header.words * sizeof(uint64_t);
+        if (position + bytes > end || (frames.empty() && !header.keyframe)) break; // cut off while writing
+        frames.push_back({header.generation, header.keyframe != 0, position});
+        position += bytes;
+        in.seekg((streamoff) position);
+    }
+    in.clear();
+}
+
+void RecordReader::read(const uint64_t& offset, BitBoard& board)
+{
+    FrameHeader header = {};
+    in.seekg((streamoff) offset);
+    if (!in.read((char*) &header, sizeof(header)))
+        throw runtime_error(string("Truncated record file: ").append(path));
+    if (header.keyframe)
+    {
+        if (board.getLines() != header.lines || board.getColumns() != header.columns)
+            board = BitBoard(header.lines, header.columns);
+        board.setOrigin(header.originLine, header.originColumn);
+        if (header.words != board.getWords().size())
+            throw runtime_error(string("Corrupted record file: ").append(path));
+        in.read((char*) board.getWords().data(), (streamsize) (board.getWords().size() * sizeof(uint64_t)));
+    }
+    else
+    {
+        runs.resize((size_t) header.runs * 2);
+        bits.resize(header.words);
+        in.read((char*) runs.data(), (streamsize) (runs.size() * sizeof(uint32_t)));
+        in.read((char*) bits.data(), (streamsize) (bits.size() * sizeof(uint64_t)));
+        uint64_t total = 0;
+        for (size_t r = 0; r < runs.size(); r += 2)
+        {
+            if ((uint64_t) runs[r] + runs[r + 1] > board.getWords().size())
+                throw runtime_error(string("Corrupted record file: ").append(path));
+            total += runs[r + 1];
+        }
+        if (total != bits.size()) throw runtime_error(string("Corrupted record file: ").append(path));
+        History::patch(runs, bits, board);
+    }
+    if (!in) throw runtime_error(string("Truncated record file: ").append(path));
+}
+
+const Rule& RecordReader::getRule() const
+{
+    return rule;
+}
+
+size_t RecordReader::size() const
+{
+    return frames.size();
+}
+
+int RecordReader::getGeneration(const size_t& frame) const
+{
+    return frames.at(frame).generation;
+}
+
+long RecordReader::find(const int& generation) const
+{
+    for (size_t i = frames.size(); i-- != 0;)
+        if (frames[i].generation == generation) return (long) i;
+    return -1;
+}
+
+void RecordReader::seek(const size_t& frame, BitBoard& board)
+{
+    if (frame >= frames.size()) throw out_of_range("Frame out of range");
+    size_t keyframe = frame;
+    while (!frames[keyframe].keyframe) --keyframe; // the first frame is always a keyframe
+    // go on from the last seek if it is on the way
+    size_t first = current >= (long) keyframe && current <= (long) frame ? (size_t) current + 1 : keyframe;
+    current = -1; // in case of a failure
+    for (size_t i = first; i <= frame; ++i)
+        read(frames[i].offset, board);
+    current = (long) frame;
+}
@@ -0,0 +1,165 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_RECORDFILE_H
+#define GOL_RECORDFILE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BitBoard.h"
+#include "Rule.h"
+
+/**
+ * The recording format (.golr), a stream of the states of a run.
+ * <br>
+ * A file is a 16-byte header (the magic "GOLR", the version and the rule)
+ * followed by frames. A frame is either a keyframe holding the words of the
+ * board, or the XOR runs against the frame before it (see History::diff()).
+ * A keyframe is written when the board is resized or moved, or once the runs
+ * since the last keyframe grow as large as the board, so seeking never reads
+ * more than about two boards. Closing the file appends the offsets of all
+ * frames and a trailer, files which were not closed are scanned instead.
+ */
+class RecordWriter
+{
+private:
+    std::ofstream out;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable ready, written;
+    std::vector<char> chunk; // the encoded frames being filled
+    std::vector<char> writing; // the encoded frames handed to the writer thread, empty once written
+    bool closing = false, failed = false;
+
+    BitBoard next; // filled by the caller
+    BitBoard previous;
+    std::vector<uint32_t> runs;
+    std::vector<uint64_t> bits;
+    std::vector<uint64_t> offsets; // of the frames, with the keyframe flag in the top bit
+    std::vector<int32_t> generations;
+    uint64_t offset = 0;
+    size_t runsSinceKeyframe = 0;
+
+    /**
+     * The main loop of the writer thread.
+     */
+    void work();
+
+    /**
+     * Hands the filled chunk to the writer thread, after it is done with the last one.
+     */
+    void flush();
+
+    void append(const void* data, const size_t& bytes);
+
+public:
+    /**
+     * The bytes of frames collected before they are written. Frames are encoded
+     * on the calling thread, only writing the chunks is left to the writer thread.
+     */
+    static const size_t CHUNK_BYTES = 1 << 20;
+
+    /**
+     * Creates a recording, replacing the file if exists.
+     * @throws std::runtime_error if the file can not be written.
+     */
+    RecordWriter(const std::string& path, const Rule& rule);
+
+    RecordWriter(const RecordWriter&) = delete;
+
+    RecordWriter& operator =(const RecordWriter&) = delete;
+
+    /**
+     * Closes the file.
+     */
+    ~RecordWriter();
+
+    /**
+     * Gets the board to copy the next frame into.
+     */
+    BitBoard& getNext();
+
+    /**
+     * Encodes the board from getNext() as the frame of a generation.
+     */
+    void commit(const int& generation);
+
+    /**
+     * Writes the remaining frames and the index, and closes the file.
+     * @return false if anything failed to be written.
+     */
+    bool close();
+};
+
+/**
+ * Reads a recording (see RecordWriter), and seeks to any frame of it.
+ */
+class RecordReader
+{
+private:
+    struct Frame
+    {
+        int generation;
+        bool keyframe;
+        uint64_t offset;
+    };
+
+    std::ifstream in;
+    std::string path;
+    Rule rule;
+    std::vector<Frame> frames;
+    long current = -1; // the frame in the board of the last seek
+    std::vector<uint32_t> runs;
+    std::vector<uint64_t> bits;
+
+    /**
+     * Reads the frame at an offset, and applies it to a board.
+     */
+    void read(const uint64_t& offset, BitBoard& board);
+
+    /**
+     * Builds the index by reading the header of every frame.
+     */
+    void scan(const uint64_t& end);
+
+public:
+    /**
+     * Opens a recording and loads its index.
+     * @throws std::runtime_error if the file can not be read or is not a recording.
+     */
+    explicit RecordReader(const std::string& path);
+
+    const Rule& getRule() const;
+
+    /**
+     * How many frames are there?
+     */
+    size_t size() const;
+
+    int getGeneration(const size_t& frame) const;
+
+    /**
+     * Finds the last frame of a generation. A generation is recorded more than
+     * once if the run was reverted, the last one is what the run went on with.
+     * @return The frame, -1 if the generation was never recorded.
+     */
+    long find(const int& generation) const;
+
+    /**
+     * Restores the board of a frame. Seeking to the next frame of the last seek only
+     * applies its runs, otherwise the board is rebuilt from the keyframe before it.
+     * @param board The board of the last seek, or any board if it is the first seek.
+     * @throws std::out_of_range if there is no such frame.
+     * @throws std::runtime_error if the file is truncated.
+     */
+    void seek(const size_t& frame, BitBoard& board);
+};
+
+#endif //GOL_RECORDFILE_H
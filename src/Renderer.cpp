@@ -0,0 +1,248 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include "Renderer.h"
+#include "CommonUtil.h"
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+#ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004
+#endif
+
+#else
+
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#endif
+
+using namespace std;
+
+namespace
+{
+    // glyphs which are not code points
+    const uint32_t GLYPH_STATE = 0x110000; // + CellState, drawn by CommonUtil::toString()
+    const uint32_t GLYPH_BLANK = 0x110010; // outside the board in RENDER_CELL mode
+    const uint32_t GLYPH_UNKNOWN = 0xFFFFFFFF; // not drawn yet
+
+    // the bit of each dot of a braille glyph, by line then column
+    const uint32_t BRAILLE_DOTS[4][2] = {{0x01, 0x08}, {0x02, 0x10}, {0x04, 0x20}, {0x40, 0x80}};
+}
+
+Renderer::Renderer()
+{
+#ifdef _WIN32
+    // let the console understand the escape codes
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD consoleMode = 0;
+    if (GetConsoleMode(out, &consoleMode))
+        SetConsoleMode(out, consoleMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+#endif
+}
+
+void Renderer::getTerminalSize(int& lines, int& columns)
+{
+    lines = 24;
+    columns = 80;
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info))
+    {
+        lines = info.srWindow.Bottom - info.srWindow.Top + 1;
+        columns = info.srWindow.Right - info.srWindow.Left + 1;
+    }
+#else
+    winsize size = {};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0)
+    {
+        lines = size.ws_row;
+        columns = size.ws_col;
+    }
+#endif
+}
+
+Renderer& Renderer::setMode(const RenderMode& renderMode)
+{
+    mode = renderMode;
+    redraw = true;
+    return *this;
+}
+
+RenderMode Renderer::getMode() const
+{
+    return mode;
+}
+
+Renderer& Renderer::setBorder(const bool& status)
+{
+    border = status;
+    redraw = true;
+    return *this;
+}
+
+Renderer& Renderer::setView(const int& line, const int& column)
+{
+    viewLine = max(line, 0);
+    viewColumn = max(column, 0);
+    return *this;
+}
+
+int Renderer::getViewLine() const
+{
+    return viewLine;
+}
+
+int Renderer::getViewColumn() const
+{
+    return viewColumn;
+}
+
+Renderer& Renderer::invalidate()
+{
+    redraw = true;
+    return *this;
+}
+
+uint32_t Renderer::glyphAt(const BitBoard& board, const int& line, const int& column) const
+{
+    if (mode == RENDER_CELL)
+    {
+        const int offset = border ? 1 : 0;
+        const int i = viewLine + line - offset, j = viewColumn + column - offset;
+        if (i >= 0 && i < board.getLines() && j >= 0 && j < board.getColumns())
+            return GLYPH_STATE + (board.get(i, j) ? STATE_ALIVE : STATE_DEAD);
+        if (border && i >= -1 && i <= board.getLines() && j >= -1 && j <= board.getColumns())
+            return GLYPH_STATE + STATE_BORDER;
+        return GLYPH_BLANK;
+    }
+
+    // pack the cells covered by the character into the dots of a glyph
+    const int cellLines = mode, cellColumns = mode == RENDER_BRAILLE ? 2 : 1;
+    uint32_t dots = 0;
+    for (int y = 0; y != cellLines; ++y)
+    {
+        const int i = viewLine + line * cellLines + y;
+        if (i >= board.getLines()) break;
+        for (int x = 0; x != cellColumns; ++x)
+        {
+            const int j = viewColumn + column * cellColumns + x;
+            if (j < board.getColumns() && board.get(i, j))
+                dots |= mode == RENDER_BRAILLE ? BRAILLE_DOTS[y][x] : 1U << y;
+        }
+    }
+    if (!dots) return ' ';
+    if (mode == RENDER_BRAILLE) return 0x2800 + dots;
+    return dots == 1 ? 0x2580 : dots == 2 ? 0x2584 : 0x2588; // upper half, lower half, full block
+}
+
+void Renderer::appendGlyph(const uint32_t& glyph)
+{
+    if (glyph == GLYPH_BLANK)
+        buffer += "  ";
+    else if (glyph >= GLYPH_STATE)
+        buffer += CommonUtil::toString((CellState) (glyph - GLYPH_STATE));
+    else if (glyph < 0x80)
+        buffer += (char) glyph;
+    else if (glyph < 0x800)
+    {
+        buffer += (char) (0xC0 | (glyph >> 6));
+        buffer += (char) (0x80 | (glyph & 0x3F));
+    }
+    else
+    {
+        buffer += (char) (0xE0 | (glyph >> 12));
+        buffer += (char) (0x80 | ((glyph >> 6) & 0x3F));
+        buffer += (char) (0x80 | (glyph & 0x3F));
+    }
+}
+
+void Renderer::moveTo(const int& line, const int& column)
+{
+    char code[32];
+    buffer.append(code, (size_t) snprintf(code, sizeof(code), "\033[%d;%dH", line + 1, column + 1));
+}
+
+void Renderer::render(const BitBoard& board, const string& status)
+{
+    int lines, columns;
+    getTerminalSize(lines, columns);
+    if (lines != screenLines || columns != screenColumns)
+    {
+        screenLines = lines;
+        screenColumns = columns;
+        redraw = true;
+    }
+
+    // the characters for the board, the status lines are below them
+    const int statusLines = (int) count(status.begin(), status.end(), '\n') + 1;
+    const int glyphWidth = mode == RENDER_CELL ? 2 : 1;
+    const int areaLines = max(1, screenLines - statusLines), areaColumns = max(1, screenColumns / glyphWidth);
+
+    // keep the viewport inside the board
+    const int cellLines = mode, cellColumns = mode == RENDER_BRAILLE ? 2 : 1;
+    const int extra = mode == RENDER_CELL && border ? 2 : 0;
+    viewLine = max(0, min(viewLine, board.getLines() + extra - areaLines * cellLines));
+    viewColumn = max(0, min(viewColumn, board.getColumns() + extra - areaColumns * cellColumns));
+
+    buffer.clear();
+    if (redraw || previous.size() != (size_t) areaLines * areaColumns)
+    {
+        buffer += "\033[H\033[2J";
+        previous.assign((size_t) areaLines * areaColumns, GLYPH_UNKNOWN);
+        previousStatus.clear();
+    }
+
+    // only draw the characters which changed, moving the cursor when skipping some
+    int cursorLine = -1, cursorColumn = -1;
+    for (int i = 0; i != areaLines; ++i)
+        for (int j = 0; j != areaColumns; ++j)
+        {
+            const uint32_t glyph = glyphAt(board, i, j);
+            uint32_t& last = previous[(size_t) i * areaColumns + j];
+            if (glyph == last) continue;
+            if (i != cursorLine || j != cursorColumn) moveTo(i, j * glyphWidth);
+            appendGlyph(glyph);
+            last = glyph;
+            cursorLine = i;
+            cursorColumn = j + 1;
+        }
+
+    if (redraw || status != previousStatus)
+    {
+        int line = areaLines;
+        size_t begin = 0;
+        for (;;)
+        {
+            const size_t end = status.find('\n', begin);
+            moveTo(line++, 0);
+            buffer.append(status, begin, end == string::npos ? string::npos : end - begin);
+            buffer += "\033[K"; // clear the rest of the line
+            if (end == string::npos) break;
+            begin = end + 1;
+        }
+        previousStatus = status;
+    }
+    redraw = false;
+
+    // everything printed before must come first
+    cout.flush();
+    fflush(stdout);
+#ifdef _WIN32
+    fwrite(buffer.data(), 1, buffer.size(), stdout);
+    fflush(stdout);
+#else
+    for (size_t written = 0; written < buffer.size();)
+    {
+        const ssize_t n = write(STDOUT_FILENO, buffer.data() + written, buffer.size() - written);
+        if (n <= 0) break;
+        written += (size_t) n;
+    }
+#endif
+}
@@ -0,0 +1,88 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_RENDERER_H
+#define GOL_RENDERER_H
+
+#include <string>
+#include <vector>
+#include "BitBoard.h"
+
+enum RenderMode
+{
+    RENDER_CELL = 1, // 1 cell per glyph, the glyphs of CommonUtil::toString()
+    RENDER_HALF_BLOCK = 2, // 1*2 cells per character with half block glyphs
+    RENDER_BRAILLE = 4 // 2*4 cells per character with braille glyphs
+};
+
+/**
+ * Draws the cell board on the terminal. The previous frame is kept, and
+ * only the characters which changed since then are redrawn, addressed by
+ * escape codes. A frame is built in one buffer and written at once.
+ * <br>
+ * When the board is larger than the terminal, only a viewport of it is
+ * drawn. The viewport can be scrolled, or zoomed out by packing several
+ * cells into a character.
+ */
+class Renderer
+{
+private:
+    RenderMode mode = RENDER_CELL;
+    bool border = false;
+    int viewLine = 0, viewColumn = 0; // the top-left cell of the viewport, 0-based
+    int screenLines = 0, screenColumns = 0; // the size of the terminal
+    bool redraw = true;
+    std::vector<uint32_t> previous; // the glyph of each character in the last frame
+    std::string previousStatus;
+    std::string buffer;
+
+    /**
+     * Gets the size of the terminal, 24*80 if unknown.
+     */
+    static void getTerminalSize(int& lines, int& columns);
+
+    /**
+     * Gets the glyph of a character on the screen, a code point or one of the cell states.
+     */
+    uint32_t glyphAt(const BitBoard& board, const int& line, const int& column) const;
+
+    void appendGlyph(const uint32_t& glyph);
+
+    void moveTo(const int& line, const int& column);
+
+public:
+    Renderer();
+
+    Renderer& setMode(const RenderMode& renderMode);
+
+    RenderMode getMode() const;
+
+    /**
+     * Also draws the border around the board, only in RENDER_CELL mode.
+     */
+    Renderer& setBorder(const bool& status);
+
+    /**
+     * Moves the top-left cell of the viewport.
+     * @param line 0-based, relative to the top-left cell of the board.
+     */
+    Renderer& setView(const int& line, const int& column);
+
+    int getViewLine() const;
+
+    int getViewColumn() const;
+
+    /**
+     * Redraws the whole screen in the next frame, e.g. after something else was printed.
+     */
+    Renderer& invalidate();
+
+    /**
+     * Draws a frame.
+     * @param status The text below the board, lines separated by '\n'.
+     */
+    void render(const BitBoard& board, const std::string& status);
+};
+
+#endif //GOL_RENDERER_H
@@ -0,0 +1,129 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <stdexcept>
+#include "Rule.h"
+
+using namespace std;
+
+Rule::Rule() : Rule(1 << 3, 1 << 2 | 1 << 3)
+{
+}
+
+Rule::Rule(const uint16_t& birth, const uint16_t& survival)
+{
+    this->birth = birth & 0x1FF;
+    this->survival = survival & 0x1FF;
+    compile();
+}
+
+void Rule::compile()
+{
+    conway = birth == 1 << 3 && survival == (1 << 2 | 1 << 3);
+    for (int n = 0; n != 9; ++n)
+    {
+        const bool born = (birth >> n) & 1, survives = (survival >> n) & 1;
+        table[n] = born;
+        table[9 + n] = survives;
+        dead[n] = born ? ~0ULL : 0;
+        change[n] = born != survives ? ~0ULL : 0;
+    }
+}
+
+Rule Rule::parse(const string& text)
+{
+    auto malformed = [&text]() {
+        return runtime_error(string("Malformed rule: ").append(text));
+    };
+
+    uint16_t masks[2] = {0, 0}; // birth, survival
+    bool seen[2] = {false, false};
+    int part = -1, parts = 0;
+    bool classic = true; // no B/S letters, "survival/birth"
+    for (const char& c : text)
+    {
+        if (c == 'B' || c == 'b' || c == 'S' || c == 's')
+        {
+            part = c == 'B' || c == 'b' ? 0 : 1;
+            if (seen[part]) throw malformed();
+            seen[part] = true;
+            classic = false;
+        }
+        else if (c == '/')
+        {
+            if (part == -1 && !seen[1]) // "/3", survival part is empty
+            {
+                part = 1;
+                seen[1] = true;
+            }
+            part = -1;
+            ++parts;
+        }
+        else if (c >= '0' && c <= '8')
+        {
+            if (part == -1)
+            {
+                if (!classic) throw malformed();
+                part = parts == 0 ? 1 : 0;
+                seen[part] = true;
+            }
+            masks[part] |= 1 << (c - '0');
+        }
+        else
+            throw malformed();
+    }
+    if (parts > 1 || (classic && parts != 1) || (!classic && (!seen[0] || !seen[1]))) throw malformed();
+    return {masks[0], masks[1]};
+}
+
+string Rule::toString() const
+{
+    string s = "B";
+    for (int n = 0; n != 9; ++n)
+        if ((birth >> n) & 1) s += (char) ('0' + n);
+    s += "/S";
+    for (int n = 0; n != 9; ++n)
+        if ((survival >> n) & 1) s += (char) ('0' + n);
+    return s;
+}
+
+uint16_t Rule::getBirth() const
+{
+    return birth;
+}
+
+uint16_t Rule::getSurvival() const
+{
+    return survival;
+}
+
+bool Rule::isConway() const
+{
+    return conway;
+}
+
+bool Rule::hasBirthOnZero() const
+{
+    return birth & 1;
+}
+
+const uint64_t* Rule::getDeadMasks() const
+{
+    return dead;
+}
+
+const uint64_t* Rule::getChangeMasks() const
+{
+    return change;
+}
+
+bool Rule::operator ==(const Rule& other) const
+{
+    return birth == other.birth && survival == other.survival;
+}
+
+bool Rule::operator !=(const Rule& other) const
+{
+    return !(*this == other);
+}
@@ -0,0 +1,103 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_RULE_H
+#define GOL_RULE_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * A Life-like rule in B/S notation, e.g. B3/S23 (Conway's Game of Life),
+ * B36/S23 (HighLife) or B2/S (Seeds): a dead cell is born with one of the
+ * B counts of live neighbours, and a live cell survives with one of the S
+ * counts.
+ * <br>
+ * A rule is compiled once into a lookup table for cell-by-cell engines,
+ * and into masks for the bit-packed engines (see apply()), so stepping
+ * never branches on the rule.
+ */
+class Rule
+{
+private:
+    uint16_t birth = 0, survival = 0; // bit n is set if n live neighbours give birth / let a cell survive
+    bool conway = false;
+    uint8_t table[18] = {}; // the next state, by (alive ? 9 : 0) + live neighbours
+    uint64_t dead[9] = {}, change[9] = {}; // by live neighbours: ~0 if a dead cell is born, ~0 if alive differs
+
+    void compile();
+
+public:
+    /**
+     * Creates B3/S23.
+     */
+    Rule();
+
+    Rule(const uint16_t& birth, const uint16_t& survival);
+
+    /**
+     * Parses a rule. Accepts "B3/S23", "b3s23", "S23/B3" and the classic "23/3" (survival/birth).
+     * @throws std::runtime_error if the rule is malformed or has a count above 8.
+     */
+    static Rule parse(const std::string& text);
+
+    /**
+     * Converts the rule to the "B3/S23" form.
+     */
+    std::string toString() const;
+
+    uint16_t getBirth() const;
+
+    uint16_t getSurvival() const;
+
+    /**
+     * Is it B3/S23? The engines have faster paths for it.
+     */
+    bool isConway() const;
+
+    /**
+     * Does a dead cell with no live neighbour come alive (B0)? Such rules
+     * turn an infinite dead plane alive, so the unbounded engines reject them.
+     */
+    bool hasBirthOnZero() const;
+
+    /**
+     * Gets the next state of a cell.
+     */
+    inline bool next(const bool& alive, const int& live) const
+    {
+        return table[(alive ? 9 : 0) + live];
+    }
+
+    /**
+     * Gets the next state of 64 cells at once from the bit planes of their live neighbour counts.
+     * @param m The current states.
+     */
+    inline uint64_t apply(const uint64_t& ones, const uint64_t& twos, const uint64_t& fours,
+                          const uint64_t& eights, const uint64_t& m) const
+    {
+        // the state for each count, then a tree of selects on the bits of the count
+        uint64_t leaf[9];
+        for (int n = 0; n != 9; ++n)
+            leaf[n] = dead[n] ^ (m & change[n]);
+        const uint64_t l01 = leaf[0] ^ ((leaf[0] ^ leaf[1]) & ones), l23 = leaf[2] ^ ((leaf[2] ^ leaf[3]) & ones);
+        const uint64_t l45 = leaf[4] ^ ((leaf[4] ^ leaf[5]) & ones), l67 = leaf[6] ^ ((leaf[6] ^ leaf[7]) & ones);
+        const uint64_t l03 = l01 ^ ((l01 ^ l23) & twos), l47 = l45 ^ ((l45 ^ l67) & twos);
+        const uint64_t l07 = l03 ^ ((l03 ^ l47) & fours);
+        return l07 ^ ((l07 ^ leaf[8]) & eights);
+    }
+
+    /**
+     * Gets the masks used by apply(), for vector kernels.
+     */
+    const uint64_t* getDeadMasks() const;
+
+    const uint64_t* getChangeMasks() const;
+
+    bool operator ==(const Rule& other) const;
+
+    bool operator !=(const Rule& other) const;
+};
+
+#endif //GOL_RULE_H
@@ -0,0 +1,230 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "SlabRunner.h"
+#include "Kernel.h"
+
+#ifndef _WIN32
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#endif
+
+using namespace std;
+
+#ifndef _WIN32
+
+namespace
+{
+    /**
+     * The start of the shared memory.
+     */
+    struct alignas(64) Header
+    {
+        atomic<bool> aborted; // set by the coordinator to stop the workers
+    };
+
+    /**
+     * The part of the shared memory written by one worker, on its own cache lines.
+     */
+    struct alignas(64) Control
+    {
+        atomic<int> published; // the generations whose halos have been published
+    };
+
+    /**
+     * Where the slab of a worker and its halos are in the shared memory.
+     */
+    struct Slab
+    {
+        int first, lines; // of the board
+        uint64_t* buffers[2]; // the current and the next state, with a halo line above and below
+        uint64_t* halos[2]; // the published first and last line, by the parity of the generation
+    };
+
+    /**
+     * The main loop of a worker process.
+     * @return The exit code.
+     */
+    int work(vector<Slab>& slabs, const int& index, Control* controls, const atomic<bool>& aborted,
+             const int& steps, const int& columns, const int& words, const bool& wrap,
+             const Kernel::LineFunction& kernel, const Rule& rule, const uint64_t* zeroLine)
+    {
+        Slab& slab = slabs[index];
+        const int count = (int) slabs.size();
+        const int up = index != 0 ? index - 1 : wrap ? count - 1 : -1;
+        const int down = index != count - 1 ? index + 1 : wrap ? 0 : -1;
+        const size_t lineBytes = words * sizeof(uint64_t);
+        const int h = slab.lines;
+
+        for (int g = 0; g != steps; ++g)
+        {
+            uint64_t* current = slab.buffers[g & 1];
+            uint64_t* next = slab.buffers[(g & 1) ^ 1];
+            auto line = [&](uint64_t* buffer, const int& i) { return buffer + (size_t) i * words; };
+
+            // publish the halos of the neighbours: the first line, then the last line
+            uint64_t* halo = slab.halos[g & 1];
+            memcpy(halo, line(current, 1), lineBytes);
+            memcpy(halo + words, line(current, h), lineBytes);
+            controls[index].published.store(g + 1, memory_order_release);
+
+            // the inner lines only need the lines of the slab itself
+            for (int i = 2; i < h; ++i)
+                Kernel::line(kernel, line(current, i - 1), line(current, i), line(current, i + 1), line(next, i),
+                             0, words, columns, wrap, rule);
+
+            // then the halos from the neighbours
+            for (const int& n : {up, down})
+                while (n >= 0 && controls[n].published.load(memory_order_acquire) < g + 1)
+                {
+                    if (aborted.load(memory_order_relaxed)) return 1;
+                    this_thread::yield();
+                }
+            memcpy(line(current, 0), up >= 0 ? slabs[up].halos[g & 1] + words : zeroLine, lineBytes);
+            memcpy(line(current, h + 1), down >= 0 ? slabs[down].halos[g & 1] : zeroLine, lineBytes);
+            Kernel::line(kernel, line(current, 0), line(current, 1), line(current, 2), line(next, 1),
+                         0, words, columns, wrap, rule);
+            if (h > 1)
+                Kernel::line(kernel, line(current, h - 1), line(current, h), line(current, h + 1), line(next, h),
+                             0, words, columns, wrap, rule);
+        }
+        return 0;
+    }
+}
+
+#endif
+
+SlabRunner::SlabRunner(const int& processes) : processes(processes)
+{
+    if (processes < 1) throw runtime_error("Process number must be >= 1");
+#ifdef _WIN32
+    if (processes > 1) throw runtime_error("Worker processes are not supported on Windows");
+#endif
+}
+
+SlabRunner& SlabRunner::setRule(const Rule& newRule)
+{
+    rule = newRule;
+    return *this;
+}
+
+SlabRunner& SlabRunner::toggleNoBorder(const bool& status)
+{
+    flNoBorder = status;
+    return *this;
+}
+
+int SlabRunner::getProcesses() const
+{
+    return processes;
+}
+
+void SlabRunner::forward(BitBoard& board, const int& steps) const
+{
+#ifdef _WIN32
+    throw runtime_error("Worker processes are not supported on Windows");
+#else
+    if (steps < 1) return;
+    const int count = min(processes, board.getLines());
+    const int words = board.getWordsPerLine();
+
+    // the header, the controls, the zero line, then the buffers and the halos of each slab
+    vector<Slab> slabs(count);
+    size_t lineCount = 1;
+    for (int i = 0; i != count; ++i)
+    {
+        slabs[i].first = (int) ((long) board.getLines() * i / count);
+        slabs[i].lines = (int) ((long) board.getLines() * (i + 1) / count) - slabs[i].first;
+        lineCount += 2 * (slabs[i].lines + 2) + 2 * 2;
+    }
+    const size_t lineBytes = words * sizeof(uint64_t);
+    const size_t bytes = sizeof(Header) + sizeof(Control) * count + lineCount * lineBytes;
+    void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) throw runtime_error("Unable to allocate shared memory for the worker processes");
+
+    Header* header = new(memory) Header{{false}};
+    Control* controls = (Control*) (header + 1);
+    for (int i = 0; i != count; ++i)
+        new(&controls[i]) Control{{0}};
+    const uint64_t* zeroLine = (uint64_t*) (controls + count); // mapped memory starts zeroed
+    uint64_t* p = (uint64_t*) (controls + count) + words;
+    for (int i = 0; i != count; ++i)
+    {
+        Slab& slab = slabs[i];
+        for (uint64_t*& buffer : slab.buffers)
+        {
+            buffer = p;
+            p += (size_t) (slab.lines + 2) * words;
+        }
+        for (uint64_t*& halo : slab.halos)
+        {
+            halo = p;
+            p += 2 * words;
+        }
+        for (int l = 0; l != slab.lines; ++l)
+            memcpy(slab.buffers[0] + (size_t) (l + 1) * words, board.line(slab.first + l), lineBytes);
+    }
+
+    const Kernel::LineFunction kernel = Kernel::get(rule);
+    const int columns = board.getColumns();
+    vector<pid_t> workers;
+    bool failed = false;
+    for (int i = 0; i != count && !failed; ++i)
+    {
+        const pid_t pid = fork();
+        if (pid == 0)
+            _exit(work(slabs, i, controls, header->aborted, steps, columns, words, flNoBorder, kernel, rule, zeroLine));
+        if (pid < 0)
+            failed = true;
+        else
+            workers.push_back(pid);
+    }
+
+    // a worker which dies would leave its neighbours waiting for ever, so stop the others;
+    // the workers are polled by pid, blocking on one could miss another one dying, and
+    // waiting for any child could reap one which is not a worker
+    if (failed) header->aborted = true;
+    while (!workers.empty())
+    {
+        bool reaped = false;
+        for (size_t i = 0; i != workers.size();)
+        {
+            int status;
+            const pid_t pid = waitpid(workers[i], &status, WNOHANG);
+            if (pid == 0 || (pid < 0 && errno == EINTR))
+            {
+                ++i; // still running
+                continue;
+            }
+            if (pid > 0 && (!WIFEXITED(status) || WEXITSTATUS(status) != 0))
+            {
+                failed = true;
+                header->aborted = true;
+            }
+            workers.erase(workers.begin() + (long) i); // exited, or already reaped if pid < 0
+            reaped = true;
+        }
+        if (!reaped) this_thread::sleep_for(chrono::microseconds(100));
+    }
+
+    if (!failed)
+        for (const Slab& slab : slabs)
+            for (int l = 0; l != slab.lines; ++l)
+                memcpy(board.line(slab.first + l), slab.buffers[steps & 1] + (size_t) (l + 1) * words, lineBytes);
+    munmap(memory, bytes);
+    if (failed) throw runtime_error("A worker process failed");
+#endif
+}
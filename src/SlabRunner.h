@@ -0,0 +1,53 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_SLABRUNNER_H
+#define GOL_SLABRUNNER_H
+
+#include "BitBoard.h"
+#include "Rule.h"
+
+/**
+ * Steps a bounded board across several worker processes on one machine, so
+ * that a giant board is not limited by the memory bandwidth of one process.
+ * <br>
+ * The board is split into horizontal slabs, one per worker, in memory shared
+ * with the workers. Each generation a worker publishes the first and the last
+ * line of its slab (the halos of its neighbours), steps the inner lines while
+ * its neighbours do the same, and only then waits for the halos from its two
+ * neighbours to step its first and last line. The halos are double-buffered,
+ * so a worker never waits for the workers other than its neighbours.
+ * <br>
+ * Everything the workers use is allocated before forking, so they never
+ * allocate. Not available on Windows.
+ */
+class SlabRunner
+{
+private:
+    Rule rule;
+    bool flNoBorder = false;
+    int processes;
+
+public:
+    /**
+     * @param processes The number of worker processes, at most one per line of the board.
+     * @throws std::runtime_error if the number is less than 1, or on Windows.
+     */
+    explicit SlabRunner(const int& processes);
+
+    SlabRunner& setRule(const Rule& newRule);
+
+    SlabRunner& toggleNoBorder(const bool& status);
+
+    int getProcesses() const;
+
+    /**
+     * Advances a board by a specified amount of generations.
+     * @throws std::runtime_error if the shared memory can not be allocated, or a worker
+     * can not be started or does not finish.
+     */
+    void forward(BitBoard& board, const int& steps) const;
+};
+
+#endif //GOL_SLABRUNNER_H
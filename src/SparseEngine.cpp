@@ -0,0 +1,302 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include <stdexcept>
+#include "SparseEngine.h"
+#include "Kernel.h"
+
+using namespace std;
+
+const int SparseEngine::CHUNK_SIZE;
+
+size_t SparseEngine::KeyHash::operator ()(const int64_t& key) const
+{
+    uint64_t h = (uint64_t) key * 0x9E3779B97F4A7C15ULL;
+    return (size_t) (h ^ (h >> 32));
+}
+
+int64_t SparseEngine::keyOf(const int& chunkLine, const int& chunkColumn)
+{
+    return (int64_t) ((uint64_t) (uint32_t) chunkLine << 32 | (uint32_t) chunkColumn);
+}
+
+int SparseEngine::chunkOf(const int& location)
+{
+    return location >= 0 ? location / CHUNK_SIZE : -((-location - 1) / CHUNK_SIZE) - 1;
+}
+
+const SparseEngine::Chunk& SparseEngine::chunkAt(const int& chunkLine, const int& chunkColumn) const
+{
+    auto it = chunks.find(keyOf(chunkLine, chunkColumn));
+    return it == chunks.end() ? emptyChunk : it->second;
+}
+
+void SparseEngine::init(const int& lines, const int& columns)
+{
+    initLines = lines;
+    initColumns = columns;
+    chunks.clear();
+    hasLife = false;
+    hash = 0;
+    population = 0;
+}
+
+int SparseEngine::getLines() const
+{
+    return hasLife ? bottom - top : initLines;
+}
+
+int SparseEngine::getColumns() const
+{
+    return hasLife ? right - left : initColumns;
+}
+
+int SparseEngine::getOriginLine() const
+{
+    return hasLife ? top : 0;
+}
+
+int SparseEngine::getOriginColumn() const
+{
+    return hasLife ? left : 0;
+}
+
+bool SparseEngine::isUnbounded() const
+{
+    return true;
+}
+
+CellState SparseEngine::getStateOf(const int& line, const int& column) const
+{
+    const int cl = chunkOf(line), cc = chunkOf(column);
+    const Chunk& c = chunkAt(cl, cc);
+    return (c.lines[line - cl * CHUNK_SIZE] >> (column - cc * CHUNK_SIZE)) & 1ULL ? STATE_ALIVE : STATE_DEAD;
+}
+
+void SparseEngine::setStateOf(const int& line, const int& column, const CellState& state)
+{
+    const int cl = chunkOf(line), cc = chunkOf(column);
+    const uint64_t bit = 1ULL << (column - cc * CHUNK_SIZE);
+    if (state == STATE_ALIVE)
+    {
+        uint64_t& l = chunks[keyOf(cl, cc)].lines[line - cl * CHUNK_SIZE];
+        if (l & bit) return;
+        hash ^= BitBoard::hashWord(line, cc, l) ^ BitBoard::hashWord(line, cc, l | bit);
+        l |= bit;
+        ++population;
+        if (!hasLife)
+        {
+            top = line;
+            left = column;
+            bottom = line + 1;
+            right = column + 1;
+            hasLife = true;
+        }
+        else
+        {
+            top = min(top, line);
+            left = min(left, column);
+            bottom = max(bottom, line + 1);
+            right = max(right, column + 1);
+        }
+        return;
+    }
+
+    auto it = chunks.find(keyOf(cl, cc));
+    if (it == chunks.end()) return;
+    uint64_t& l = it->second.lines[line - cl * CHUNK_SIZE];
+    if (!(l & bit)) return;
+    hash ^= BitBoard::hashWord(line, cc, l) ^ BitBoard::hashWord(line, cc, l & ~bit);
+    l &= ~bit; // the chunk is freed in the next step if empty
+    --population;
+    if (line == top || line == bottom - 1 || column == left || column == right - 1)
+        measure();
+}
+
+void SparseEngine::setNoBorder(const bool& status)
+{
+    if (status) throw runtime_error("The unbounded universe does not have a border");
+}
+
+void SparseEngine::setRule(const Rule& newRule)
+{
+    if (newRule.hasBirthOnZero()) throw runtime_error("B0 rules are not supported by the unbounded universe");
+    rule = newRule;
+}
+
+void SparseEngine::grow()
+{
+    vector<int64_t> wanted;
+    for (auto& kv : chunks)
+    {
+        const Chunk& c = kv.second;
+        uint64_t columns = 0;
+        for (const uint64_t& l : c.lines)
+            columns |= l;
+        if (!columns) continue;
+
+        const int cl = (int) (kv.first >> 32), cc = (int) (uint32_t) kv.first;
+        const uint64_t first = c.lines[0], last = c.lines[CHUNK_SIZE - 1];
+        const uint64_t west = 1ULL, east = 1ULL << (CHUNK_SIZE - 1);
+        if (first) wanted.push_back(keyOf(cl - 1, cc));
+        if (last) wanted.push_back(keyOf(cl + 1, cc));
+        if (columns & west) wanted.push_back(keyOf(cl, cc - 1));
+        if (columns & east) wanted.push_back(keyOf(cl, cc + 1));
+        if (first & west) wanted.push_back(keyOf(cl - 1, cc - 1));
+        if (first & east) wanted.push_back(keyOf(cl - 1, cc + 1));
+        if (last & west) wanted.push_back(keyOf(cl + 1, cc - 1));
+        if (last & east) wanted.push_back(keyOf(cl + 1, cc + 1));
+    }
+    for (const int64_t& key : wanted)
+        chunks[key]; // inserts an empty chunk if not allocated yet
+}
+
+void SparseEngine::stepChunk(const int64_t& key, Chunk& c) const
+{
+    const int cl = (int) (key >> 32), cc = (int) (uint32_t) key;
+    const Chunk& n = chunkAt(cl - 1, cc), & s = chunkAt(cl + 1, cc);
+    const Chunk& w = chunkAt(cl, cc - 1), & e = chunkAt(cl, cc + 1);
+    const Chunk& nw = chunkAt(cl - 1, cc - 1), & ne = chunkAt(cl - 1, cc + 1);
+    const Chunk& sw = chunkAt(cl + 1, cc - 1), & se = chunkAt(cl + 1, cc + 1);
+    const int last = CHUNK_SIZE - 1;
+
+    for (int y = 0; y != CHUNK_SIZE; ++y)
+    {
+        // the line above, the line itself and the line below, each with the words of the chunks beside
+        const uint64_t u = y ? c.lines[y - 1] : n.lines[last];
+        const uint64_t uw = y ? w.lines[y - 1] : nw.lines[last], ue = y ? e.lines[y - 1] : ne.lines[last];
+        const uint64_t m = c.lines[y], mw = w.lines[y], me = e.lines[y];
+        const uint64_t d = y != last ? c.lines[y + 1] : s.lines[0];
+        const uint64_t dw = y != last ? w.lines[y + 1] : sw.lines[0], de = y != last ? e.lines[y + 1] : se.lines[0];
+        c.next[y] = Kernel::word((u << 1) | (uw >> 63), u, (u >> 1) | (ue << 63),
+                                 (m << 1) | (mw >> 63), m, (m >> 1) | (me << 63),
+                                 (d << 1) | (dw >> 63), d, (d >> 1) | (de << 63), rule);
+    }
+}
+
+void SparseEngine::step()
+{
+    grow();
+
+    vector<pair<int64_t, Chunk*>> list;
+    list.reserve(chunks.size());
+    for (auto& kv : chunks)
+        list.emplace_back(kv.first, &kv.second);
+    parallelFor((int) list.size(), [&](const int& begin, const int& end) {
+        for (int i = begin; i != end; ++i)
+            stepChunk(list[i].first, *list[i].second);
+    });
+
+    // apply the next states and free the dead chunks
+    evaluatedCells = (uint64_t) list.size() * CHUNK_SIZE * CHUNK_SIZE;
+    births = deaths = 0;
+    for (auto& p : list)
+    {
+        const int cl = (int) (p.first >> 32), cc = (int) (uint32_t) p.first;
+        uint64_t any = 0;
+        for (int y = 0; y != CHUNK_SIZE; ++y)
+        {
+            uint64_t& l = p.second->lines[y];
+            const uint64_t n = p.second->next[y];
+            if (l != n)
+            {
+                hash ^= BitBoard::hashWord(cl * CHUNK_SIZE + y, cc, l) ^ BitBoard::hashWord(cl * CHUNK_SIZE + y, cc, n);
+                births += __builtin_popcountll(n & ~l);
+                deaths += __builtin_popcountll(l & ~n);
+            }
+            any |= l = n;
+        }
+        if (!any) chunks.erase(p.first);
+    }
+    population += births - deaths;
+    measure();
+}
+
+void SparseEngine::measure()
+{
+    hasLife = false;
+    for (auto& kv : chunks)
+    {
+        const Chunk& c = kv.second;
+        const int cl = (int) (kv.first >> 32), cc = (int) (uint32_t) kv.first;
+        for (int y = 0; y != CHUNK_SIZE; ++y)
+        {
+            const uint64_t l = c.lines[y];
+            if (!l) continue;
+            const int line = cl * CHUNK_SIZE + y;
+            const int first = cc * CHUNK_SIZE + __builtin_ctzll(l), last = cc * CHUNK_SIZE + 63 - __builtin_clzll(l);
+            if (!hasLife)
+            {
+                top = line;
+                bottom = line + 1;
+                left = first;
+                right = last + 1;
+                hasLife = true;
+            }
+            else
+            {
+                top = min(top, line);
+                bottom = max(bottom, line + 1);
+                left = min(left, first);
+                right = max(right, last + 1);
+            }
+        }
+    }
+}
+
+void SparseEngine::store(BitBoard& board) const
+{
+    board = BitBoard(getLines(), getColumns());
+    board.setOrigin(getOriginLine(), getOriginColumn());
+    if (!hasLife) return;
+    for (auto& kv : chunks)
+    {
+        const int cl = (int) (kv.first >> 32), cc = (int) (uint32_t) kv.first;
+        for (int y = 0; y != CHUNK_SIZE; ++y)
+            for (uint64_t l = kv.second.lines[y]; l; l &= l - 1)
+                board.set(cl * CHUNK_SIZE + y - top, cc * CHUNK_SIZE + __builtin_ctzll(l) - left, true);
+    }
+}
+
+void SparseEngine::load(const BitBoard& board)
+{
+    chunks.clear();
+    hasLife = false;
+    hash = 0;
+    population = 0;
+    for (int i = 0; i != board.getLines(); ++i)
+    {
+        const uint64_t* l = board.line(i);
+        for (int w = 0; w != board.getWordsPerLine(); ++w)
+            for (uint64_t bits = l[w]; bits; bits &= bits - 1)
+                setStateOf(board.getOriginLine() + i, board.getOriginColumn() + w * 64 + __builtin_ctzll(bits),
+                           STATE_ALIVE);
+    }
+}
+
+uint64_t SparseEngine::getHash() const
+{
+    return hash;
+}
+
+size_t SparseEngine::getChunkCount() const
+{
+    return chunks.size();
+}
+
+uint64_t SparseEngine::getPopulation() const
+{
+    return population;
+}
+
+bool SparseEngine::getBoundingBox(int& boxTop, int& boxLeft, int& boxBottom, int& boxRight) const
+{
+    if (!hasLife) return false;
+    boxTop = top;
+    boxLeft = left;
+    boxBottom = bottom;
+    boxRight = right;
+    return true;
+}
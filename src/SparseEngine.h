@@ -0,0 +1,116 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_SPARSEENGINE_H
+#define GOL_SPARSEENGINE_H
+
+#include <unordered_map>
+#include "Engine.h"
+
+/**
+ * The unbounded engine. The universe is an infinite plane made of 64*64
+ * chunks stored in a hash map. A chunk is allocated when live cells reach
+ * its edge and freed once all of its cells are dead, so the memory and the
+ * time of a step only depend on the live region.
+ * <br>
+ * Locations are absolute, and the cell board is the bounding box of the
+ * live cells (or the initial size if there is none).
+ */
+class SparseEngine : public Engine
+{
+private:
+    static const int CHUNK_SIZE = 64;
+
+    struct Chunk
+    {
+        uint64_t lines[CHUNK_SIZE]; // column x of a chunk is bit x of a line
+        uint64_t next[CHUNK_SIZE];
+    };
+
+    struct KeyHash
+    {
+        size_t operator ()(const int64_t& key) const;
+    };
+
+    std::unordered_map<int64_t, Chunk, KeyHash> chunks;
+    Chunk emptyChunk = {}; // stands for the chunks not allocated
+    int initLines = 0, initColumns = 0;
+    int top = 0, left = 0, bottom = 0, right = 0; // the bounding box of the live cells, bottom and right excluded
+    uint64_t population = 0;
+    bool hasLife = false;
+    uint64_t hash = 0; // the hash of all chunks, by absolute locations
+
+    static int64_t keyOf(const int& chunkLine, const int& chunkColumn);
+
+    /**
+     * Gets the chunk containing a location. Works for negative locations.
+     */
+    static int chunkOf(const int& location);
+
+    const Chunk& chunkAt(const int& chunkLine, const int& chunkColumn) const;
+
+    /**
+     * Allocates the chunks next to the live cells on the edges of the allocated chunks.
+     */
+    void grow();
+
+    /**
+     * Calculates the next state of a chunk, without applying it.
+     */
+    void stepChunk(const int64_t& key, Chunk& c) const;
+
+    /**
+     * Finds the bounding box of the live cells.
+     */
+    void measure();
+
+public:
+    void init(const int& lines, const int& columns) override;
+
+    /**
+     * Gets the lines of the bounding box of the live cells.
+     */
+    int getLines() const override;
+
+    int getColumns() const override;
+
+    int getOriginLine() const override;
+
+    int getOriginColumn() const override;
+
+    bool isUnbounded() const override;
+
+    CellState getStateOf(const int& line, const int& column) const override;
+
+    void setStateOf(const int& line, const int& column, const CellState& state) override;
+
+    /**
+     * @throws std::runtime_error if trying to turn on the transparent border.
+     */
+    void setNoBorder(const bool& status) override;
+
+    /**
+     * @throws std::runtime_error if the rule has B0.
+     */
+    void setRule(const Rule& newRule) override;
+
+    void step() override;
+
+    void store(BitBoard& board) const override;
+
+    uint64_t getPopulation() const override;
+
+    bool getBoundingBox(int& boxTop, int& boxLeft, int& boxBottom, int& boxRight) const override;
+
+    void load(const BitBoard& board) override;
+
+    uint64_t getHash() const override;
+
+    /**
+     * How many chunks are allocated?
+     */
+    size_t getChunkCount() const;
+};
+
+#endif //GOL_SPARSEENGINE_H
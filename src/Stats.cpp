@@ -0,0 +1,177 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include "Stats.h"
+
+using namespace std;
+
+namespace
+{
+    const char* const NAMES[PHASE_COUNT] = {"step", "calculate", "apply", "hash", "history",
+                                            "record", "checkpoint", "frame", "render"};
+
+    bool endsWith(const string& s, const string& suffix)
+    {
+        return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+const size_t Stats::TRACE_LIMIT;
+
+Stats::Stats() : generations(0), evaluatedCells(0), changedCells(0), population(0), historyBytes(0),
+                 start(now()), tracing(false), lineTime(start)
+{
+    for (Timing& timing : timings)
+    {
+        timing.count = 0;
+        timing.nanos = 0;
+        timing.maxNanos = 0;
+    }
+}
+
+uint64_t Stats::now()
+{
+    return (uint64_t) chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* Stats::getName(const Phase& phase)
+{
+    return NAMES[phase];
+}
+
+void Stats::setTracing(const bool& status)
+{
+    tracing = status;
+}
+
+void Stats::addPhase(const Phase& phase, const uint64_t& begin, const uint64_t& end)
+{
+    const uint64_t nanos = end - begin;
+    Timing& timing = timings[phase];
+    timing.count.fetch_add(1, memory_order_relaxed);
+    timing.nanos.fetch_add(nanos, memory_order_relaxed);
+    uint64_t max = timing.maxNanos.load(memory_order_relaxed);
+    while (nanos > max && !timing.maxNanos.compare_exchange_weak(max, nanos, memory_order_relaxed));
+
+    if (!tracing.load(memory_order_relaxed)) return;
+    lock_guard<mutex> lock(traceMutex);
+    if (events.size() == TRACE_LIMIT)
+    {
+        ++droppedEvents;
+        return;
+    }
+    const thread::id id = this_thread::get_id();
+    const size_t index = find(threads.begin(), threads.end(), id) - threads.begin();
+    if (index == threads.size()) threads.push_back(id);
+    events.push_back({phase, (uint32_t) index, begin - start, nanos});
+}
+
+void Stats::addGenerations(const uint64_t& count, const uint64_t& evaluated, const uint64_t& changed)
+{
+    generations.fetch_add(count, memory_order_relaxed);
+    evaluatedCells.fetch_add(evaluated, memory_order_relaxed);
+    changedCells.fetch_add(changed, memory_order_relaxed);
+}
+
+void Stats::sample(const uint64_t& currentPopulation, const uint64_t& currentHistoryBytes)
+{
+    population = currentPopulation;
+    historyBytes = currentHistoryBytes;
+}
+
+string Stats::getLine()
+{
+    const uint64_t time = now(), gens = generations, evaluated = evaluatedCells, changed = changedCells;
+    const double seconds = (double) (time - lineTime) / 1e9;
+    const uint64_t newGenerations = gens - lineGenerations;
+    stringstream line;
+    line << fixed << setprecision(1) << "Stats: " << (seconds > 0 ? (double) newGenerations / seconds : 0) << " gen/s";
+    line << setprecision(3);
+    for (int p = 0; p != PHASE_COUNT; ++p)
+    {
+        const uint64_t count = timings[p].count, nanos = timings[p].nanos;
+        if (count != lineCounts[p])
+            line << ", " << NAMES[p] << " " << (double) (nanos - lineNanos[p]) / (double) (count - lineCounts[p]) / 1e6 << " ms";
+        lineCounts[p] = count;
+        lineNanos[p] = nanos;
+    }
+    if (newGenerations != 0)
+        line << setprecision(0) << ", " << (double) (evaluated - lineEvaluated) / (double) newGenerations
+             << " cells evaluated/gen, " << (double) (changed - lineChanged) / (double) newGenerations << " changed/gen";
+    line << ", population " << population << ", history " << setprecision(1) << (double) historyBytes / (1 << 20) << " MiB";
+    lineTime = time;
+    lineGenerations = gens;
+    lineEvaluated = evaluated;
+    lineChanged = changed;
+    return line.str();
+}
+
+void Stats::write(const string& path) const
+{
+    const double seconds = (double) (now() - start) / 1e9;
+    ofstream out(path, ios::trunc);
+    if (endsWith(path, ".json"))
+    {
+        out << "{\n  \"seconds\": " << seconds
+            << ",\n  \"generations\": " << generations
+            << ",\n  \"cells_evaluated\": " << evaluatedCells
+            << ",\n  \"cells_changed\": " << changedCells
+            << ",\n  \"population\": " << population
+            << ",\n  \"history_bytes\": " << historyBytes
+            << ",\n  \"phases\": {";
+        for (int p = 0; p != PHASE_COUNT; ++p)
+        {
+            const uint64_t count = timings[p].count;
+            out << (p != 0 ? "," : "") << "\n    \"" << NAMES[p] << "\": {\"count\": " << count
+                << ", \"total_ms\": " << (double) timings[p].nanos / 1e6
+                << ", \"mean_us\": " << (count != 0 ? (double) timings[p].nanos / (double) count / 1e3 : 0)
+                << ", \"max_us\": " << (double) timings[p].maxNanos / 1e3 << "}";
+        }
+        out << "\n  }\n}\n";
+    }
+    else
+    {
+        out << "metric,value\n"
+            << "seconds," << seconds << '\n'
+            << "generations," << generations << '\n'
+            << "cells_evaluated," << evaluatedCells << '\n'
+            << "cells_changed," << changedCells << '\n'
+            << "population," << population << '\n'
+            << "history_bytes," << historyBytes << '\n';
+        for (int p = 0; p != PHASE_COUNT; ++p)
+        {
+            const uint64_t count = timings[p].count;
+            out << NAMES[p] << ".count," << count << '\n'
+                << NAMES[p] << ".total_ms," << (double) timings[p].nanos / 1e6 << '\n'
+                << NAMES[p] << ".mean_us," << (count != 0 ? (double) timings[p].nanos / (double) count / 1e3 : 0) << '\n'
+                << NAMES[p] << ".max_us," << (double) timings[p].maxNanos / 1e3 << '\n';
+        }
+    }
+    out.close();
+    if (out.fail()) throw runtime_error(string("Unable to write stats file: ").append(path));
+}
+
+void Stats::writeTrace(const string& path)
+{
+    lock_guard<mutex> lock(traceMutex);
+    ofstream out(path, ios::trunc);
+    out << fixed << setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped_events\": "
+        << droppedEvents << "}, \"traceEvents\": [";
+    for (size_t i = 0; i != threads.size(); ++i)
+        out << (i != 0 ? "," : "") << "\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << i
+            << ", \"args\": {\"name\": \"thread " << i << "\"}}";
+    for (const Event& event : events)
+        out << ",\n{\"name\": \"" << NAMES[event.phase] << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.thread
+            << ", \"ts\": " << (double) event.begin / 1e3 << ", \"dur\": " << (double) event.duration / 1e3 << "}";
+    out << "\n]}\n";
+    out.close();
+    if (out.fail()) throw runtime_error(string("Unable to write trace file: ").append(path));
+}
@@ -0,0 +1,172 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_STATS_H
+#define GOL_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * The timed phases of a run.
+ */
+enum Phase
+{
+    PHASE_STEP = 0, // the engine stepping the board, including the two below
+    PHASE_CALCULATE = 1, // the cell engine calculating the next states
+    PHASE_APPLY = 2, // the cell engine applying the next states
+    PHASE_HASH = 3, // hashing the board to detect cycles
+    PHASE_HISTORY = 4, // pushing the last state to the undo history
+    PHASE_RECORD = 5, // encoding the frame of a recording
+    PHASE_CHECKPOINT = 6, // copying the board for a checkpoint
+    PHASE_FRAME = 7, // copying the board for the render thread
+    PHASE_RENDER = 8, // drawing a frame to the terminal
+    PHASE_COUNT = 9
+};
+
+/**
+ * Timings and counters of a run: how many times each phase ran and how long
+ * it took (measured with the monotonic clock), the cells evaluated and changed
+ * by the engine, and the population and the history bytes sampled by the caller.
+ * <br>
+ * Phases may be timed from any thread. Each timed phase can also be kept as an
+ * event of a Chrome trace (chrome://tracing, Perfetto), up to TRACE_LIMIT events.
+ * <br>
+ * The timers are placed with GOL_PHASE(), which compiles to nothing unless
+ * built with GOL_STATS (the CMake option of the same name, on by default).
+ */
+class Stats
+{
+private:
+    struct Timing
+    {
+        std::atomic<uint64_t> count, nanos, maxNanos;
+    };
+
+    struct Event
+    {
+        Phase phase;
+        uint32_t thread; // the index in threads
+        uint64_t begin, duration; // in nanoseconds since the stats were created
+    };
+
+    Timing timings[PHASE_COUNT];
+    std::atomic<uint64_t> generations, evaluatedCells, changedCells;
+    std::atomic<uint64_t> population, historyBytes;
+    uint64_t start; // when the stats were created
+    std::atomic<bool> tracing;
+    std::mutex traceMutex;
+    std::vector<Event> events; // guarded by traceMutex
+    std::vector<std::thread::id> threads; // guarded by traceMutex
+    uint64_t droppedEvents = 0; // guarded by traceMutex
+
+    // the totals when getLine() was last called
+    uint64_t lineTime, lineGenerations = 0, lineEvaluated = 0, lineChanged = 0;
+    uint64_t lineCounts[PHASE_COUNT] = {}, lineNanos[PHASE_COUNT] = {};
+
+public:
+    /**
+     * How many events of a Chrome trace are kept, the later ones are dropped.
+     */
+    static const size_t TRACE_LIMIT = 1 << 20;
+
+    Stats();
+
+    Stats(const Stats&) = delete;
+
+    Stats& operator =(const Stats&) = delete;
+
+    /**
+     * Reads the monotonic clock.
+     * @return Nanoseconds since an unspecified point.
+     */
+    static uint64_t now();
+
+    /**
+     * Gets the name of a phase, e.g. "step".
+     */
+    static const char* getName(const Phase& phase);
+
+    /**
+     * Turns on/off keeping the timed phases as trace events, off by default.
+     */
+    void setTracing(const bool& status);
+
+    /**
+     * Adds a run of a phase.
+     * @param begin When the phase began, from now().
+     * @param end When the phase ended, from now().
+     */
+    void addPhase(const Phase& phase, const uint64_t& begin, const uint64_t& end);
+
+    /**
+     * Adds generations, and the cells the engine evaluated and changed in them.
+     */
+    void addGenerations(const uint64_t& count, const uint64_t& evaluated, const uint64_t& changed);
+
+    /**
+     * Samples the population and the bytes taken by the undo history.
+     */
+    void sample(const uint64_t& currentPopulation, const uint64_t& currentHistoryBytes);
+
+    /**
+     * Gets a line of the rates and the mean times of the phases since the last call.
+     */
+    std::string getLine();
+
+    /**
+     * Writes the totals to a file, as JSON if the extension is .json, otherwise as CSV.
+     * @throws std::runtime_error if the file can not be written.
+     */
+    void write(const std::string& path) const;
+
+    /**
+     * Writes the trace events to a file in the Chrome trace format (JSON).
+     * @throws std::runtime_error if the file can not be written.
+     */
+    void writeTrace(const std::string& path);
+};
+
+/**
+ * Times a phase from its construction to its destruction, does nothing if the stats are null.
+ */
+class PhaseTimer
+{
+private:
+    Stats* stats;
+    Phase phase;
+    uint64_t begin;
+
+public:
+    PhaseTimer(Stats* stats, const Phase& phase) : stats(stats), phase(phase), begin(stats ? Stats::now() : 0)
+    {
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+
+    PhaseTimer& operator =(const PhaseTimer&) = delete;
+
+    ~PhaseTimer()
+    {
+        if (stats) stats->addPhase(phase, begin, Stats::now());
+    }
+};
+
+#ifdef GOL_STATS
+#define GOL_STATS_CONCAT_(a, b) a##b
+#define GOL_STATS_CONCAT(a, b) GOL_STATS_CONCAT_(a, b)
+
+/**
+ * Times the rest of the enclosing scope as a phase, if the stats (a Stats*) are not null.
+ */
+#define GOL_PHASE(stats, phase) PhaseTimer GOL_STATS_CONCAT(phaseTimer, __LINE__)((stats), (phase))
+#else
+#define GOL_PHASE(stats, phase)
+#endif
+
+#endif //GOL_STATS_H
@@ -0,0 +1,82 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#include <algorithm>
+#include "ThreadPool.h"
+
+using namespace std;
+
+ThreadPool::ThreadPool(const int& threads) : nextIndex(0)
+{
+    for (int i = 1; i < threads; ++i)
+        workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread& w : workers)
+        w.join();
+}
+
+int ThreadPool::getThreads() const
+{
+    return (int) workers.size() + 1;
+}
+
+void ThreadPool::parallelFor(const int& count, const function<void(const int&, const int&)>& body)
+{
+    if (count <= 0) return;
+    if (workers.empty() || count == 1)
+    {
+        body(0, count);
+        return;
+    }
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        task = &body;
+        total = count;
+        // several bands per thread so that the threads can balance the load among themselves
+        chunk = max(1, count / (getThreads() * 4));
+        nextIndex.store(0);
+        busy = (int) workers.size();
+        ++epoch;
+    }
+    wake.notify_all();
+    drain();
+
+    unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return busy == 0; });
+    task = nullptr;
+}
+
+void ThreadPool::work()
+{
+    unsigned long seenEpoch = 0;
+    for (;;)
+    {
+        {
+            unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || epoch != seenEpoch; });
+            if (stopping) return;
+            seenEpoch = epoch;
+        }
+        drain();
+        {
+            lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0) done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::drain()
+{
+    for (int begin = nextIndex.fetch_add(chunk); begin < total; begin = nextIndex.fetch_add(chunk))
+        (*task)(begin, min(begin + chunk, total));
+}
@@ -0,0 +1,70 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_THREADPOOL_H
+#define GOL_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A persistent pool of worker threads used to step the cell board in parallel.
+ * <br>
+ * The work is split into small bands which are grabbed by the idle threads
+ * from a shared counter, so a slow band does not hold up the others.
+ * The calling thread also takes part in the work.
+ */
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    const std::function<void(const int&, const int&)>* task = nullptr;
+    std::atomic<int> nextIndex;
+    int total = 0, chunk = 1, busy = 0;
+    unsigned long epoch = 0;
+    bool stopping = false;
+
+    /**
+     * The main loop of a worker thread.
+     */
+    void work();
+
+    /**
+     * Keeps grabbing bands of the current task until all of them are taken.
+     */
+    void drain();
+
+public:
+    /**
+     * Starts the pool.
+     * @param threads The total number of threads, including the calling thread.
+     */
+    explicit ThreadPool(const int& threads);
+
+    ThreadPool(const ThreadPool&) = delete;
+
+    ThreadPool& operator =(const ThreadPool&) = delete;
+
+    ~ThreadPool();
+
+    /**
+     * How many threads does the pool have? The calling thread is included.
+     */
+    int getThreads() const;
+
+    /**
+     * Runs body(begin, end) over [0, count) in parallel, and returns after all bands are done.
+     * @param count The number of work items, e.g. the lines of the cell board.
+     * @param body The function to run on the range [begin, end).
+     */
+    void parallelFor(const int& count, const std::function<void(const int&, const int&)>& body);
+};
+
+#endif //GOL_THREADPOOL_H
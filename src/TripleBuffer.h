@@ -0,0 +1,76 @@
+//
+// Created by mcumbrella on 26-10-18.
+//
+
+#ifndef GOL_TRIPLEBUFFER_H
+#define GOL_TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Passes the latest value from one producer thread to one consumer thread
+ * without locking. The producer fills its own slot and swaps it with the
+ * middle slot, the consumer swaps its own slot with the middle slot when a
+ * new value is there. Neither of them waits for the other, and the values
+ * published while the consumer is busy are dropped except the latest one.
+ */
+template<typename T>
+class TripleBuffer
+{
+private:
+    static const uint8_t FRESH = 4; // set in the state if the middle slot has not been taken
+
+    T slots[3];
+    std::atomic<uint8_t> middle; // the index of the middle slot, and FRESH
+    uint8_t back = 0, front = 2; // the slots owned by the producer and the consumer
+
+public:
+    TripleBuffer() : middle(1)
+    {
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+
+    TripleBuffer& operator =(const TripleBuffer&) = delete;
+
+    /**
+     * Gets the slot to fill, only called by the producer.
+     */
+    T& getBack()
+    {
+        return slots[back];
+    }
+
+    /**
+     * Makes the filled slot the latest value, only called by the producer.
+     */
+    void publish()
+    {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & 3;
+    }
+
+    /**
+     * Takes the latest value if it has not been taken, only called by the consumer.
+     * @return false if nothing was published since the last call.
+     */
+    bool acquire()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & 3;
+        return true;
+    }
+
+    /**
+     * Gets the value taken by acquire(), only called by the consumer.
+     */
+    const T& getFront() const
+    {
+        return slots[front];
+    }
+};
+
+template<typename T>
+const uint8_t TripleBuffer<T>::FRESH;
+
+#endif //GOL_TRIPLEBUFFER_H